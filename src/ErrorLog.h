@@ -0,0 +1,243 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+
+#include "IpFrameParser.h"
+#include "pcap/Frame.h"
+
+/**
+ * Flow is the destination of a packet: the IP address and the UDP port.
+ * The family is 0 if the frame has no IP header, the port is 0 if it has no UDP header.
+ */
+struct Flow {
+	uint8_t addr[16];
+	uint16_t port;
+	uint8_t family; // AF_INET, AF_INET6 or 0
+
+	inline bool operator==(const Flow& other) const noexcept {
+		return family == other.family && port == other.port && memcmp(addr, other.addr, sizeof(addr)) == 0;
+	}
+
+	struct Hash {
+		inline size_t operator()(const Flow& flow) const noexcept {
+			uint64_t words[2];
+			memcpy(words, flow.addr, sizeof(words));
+			return size_t((words[0] ^ (words[1] * 0x9E3779B97F4A7C15ull) ^ (uint64_t(flow.port) << 8u) ^ flow.family)
+			              * 0xFF51AFD7ED558CCDull);
+		}
+	};
+
+	void dump(FILE* out) const noexcept {
+		char text[INET6_ADDRSTRLEN];
+		if(family == 0 || not inet_ntop(family, addr, text, sizeof(text))) {
+			fprintf(out, "-");
+		} else if(family == AF_INET6) {
+			fprintf(out, "[%s]:%u", text, port);
+		} else {
+			fprintf(out, "%s:%u", text, port);
+		}
+	}
+};
+
+/**
+ * ErrorLog counts the dropped frames by reason and by flow instead of printing every one of them.
+ * The first 'samples' frame indices of every reason are kept to find the frames in the capture.
+ * The summary is printed by dump(), and every 'interval' of the wall time by tick() if it is set.
+ *
+ * The frames are dropped rarely, so report() might be slow: it restores the flow from the frame headers.
+ **/
+class ErrorLog {
+public:
+
+	enum class Reason : uint8_t {
+		NotUdp,            // the frame is not a UDP packet
+		PacketHeader,      // simba::MarketDataPacketHeader is missed
+		IncrementalHeader, // simba::IncrementalHeader is missed
+		MessageHeader,     // simba::SBEMessageHeader is missed
+		UnknownSchema,     // detail - the schema id
+		UnknownTemplate,   // detail - the template id
+		BlockLength,       // SBEMessageHeader::BlockLength mismatch, detail - the block length
+		MessageBody,       // the message body is missed
+		GroupSize,         // simba::GroupSize is missed
+		GroupLength,       // the group is longer than the packet, detail - the group length
+		COUNT
+	};
+
+	static const char* reason_name(Reason reason) noexcept {
+		static const char* names[] = {
+			"NotUdp",
+			"PacketHeader",
+			"IncrementalHeader",
+			"MessageHeader",
+			"UnknownSchema",
+			"UnknownTemplate",
+			"BlockLength",
+			"MessageBody",
+			"GroupSize",
+			"GroupLength",
+		};
+		return names[static_cast<uint8_t>(reason)];
+	}
+
+	static constexpr uint32_t TICK_MASK = 4095u; // the clock is read every 4096 ticks
+
+protected:
+
+	struct Sample {
+		uint64_t frame_index;
+		uint32_t detail;
+	};
+
+	struct FlowCounters {
+		Flow flow;
+		uint64_t counts[size_t(Reason::COUNT)];
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	const size_t _samples;
+	const Clock::duration _interval;
+	FILE* const _out;
+	uint64_t _counts[size_t(Reason::COUNT)];
+	std::vector<Sample> _sampled[size_t(Reason::COUNT)];
+	std::unordered_map<Flow, uint32_t, Flow::Hash> _flow_index;
+	std::vector<FlowCounters> _flows;
+	pcap::Frame _scratch;
+	uint32_t _ticks;
+	Clock::time_point _next;
+
+public:
+
+	ErrorLog(const ErrorLog&) = delete;
+	ErrorLog& operator=(const ErrorLog&) = delete;
+
+	/**
+	 * @param samples - the number of frame indices kept per reason.
+	 * @param interval_ms - print the summary to @out every @interval_ms milliseconds, 0 - only on demand.
+	 */
+	explicit ErrorLog(size_t samples = 8u, uint64_t interval_ms = 0, FILE* out = stderr) noexcept :
+		_samples(samples),
+		_interval(std::chrono::milliseconds(interval_ms)),
+		_out(out),
+		_counts(),
+		_sampled(),
+		_flow_index(),
+		_flows(),
+		_scratch(),
+		_ticks(0),
+		_next(Clock::now() + _interval) {}
+
+	inline uint64_t total() const noexcept {
+		uint64_t result = 0;
+		for(uint64_t count : _counts) {
+			result += count;
+		}
+		return result;
+	}
+
+	inline uint64_t count(Reason reason) const noexcept {
+		return _counts[static_cast<uint8_t>(reason)];
+	}
+
+	/**
+	 * Count the dropped @frame.
+	 * @param detail - the reason specific value, see Reason.
+	 */
+	void report(const pcap::Frame& frame, Reason reason, uint32_t detail = 0) noexcept {
+		const uint8_t idx = static_cast<uint8_t>(reason);
+		_counts[idx]++;
+		if(_sampled[idx].size() < _samples) {
+			_sampled[idx].push_back(Sample{frame.index(), detail});
+		}
+
+		const Flow flow = flow_of(frame);
+		auto it = _flow_index.find(flow);
+		if(it == _flow_index.end()) {
+			it = _flow_index.emplace(flow, uint32_t(_flows.size())).first;
+			_flows.push_back(FlowCounters{flow, {}});
+		}
+		_flows[it->second].counts[idx]++;
+	}
+
+	/**
+	 * Print the summary if the interval has elapsed, it is called for every frame.
+	 */
+	inline void tick() noexcept {
+		if(_interval.count() && (++_ticks & TICK_MASK) == 0) {
+			const Clock::time_point now = Clock::now();
+			if(now >= _next) {
+				_next = now + _interval;
+				dump(_out);
+			}
+		}
+	}
+
+	void dump(FILE* out) const noexcept {
+		fprintf(out, "Errors [ total=%lu flows=%zu ]\n", total(), _flows.size());
+		for(uint8_t idx = 0; idx < uint8_t(Reason::COUNT); ++idx) {
+			if(_counts[idx] == 0) {
+				continue;
+			}
+			fprintf(out, "  %-20s %12lu | frames:", reason_name(static_cast<Reason>(idx)), _counts[idx]);
+			for(const Sample& sample : _sampled[idx]) {
+				fprintf(out, sample.detail ? " %lu(%u)" : " %lu", sample.frame_index, sample.detail);
+			}
+			fprintf(out, _counts[idx] > _sampled[idx].size() ? " ...\n" : "\n");
+		}
+		for(const FlowCounters& counters : _flows) {
+			fprintf(out, "  flow ");
+			counters.flow.dump(out);
+			fprintf(out, " |");
+			for(uint8_t idx = 0; idx < uint8_t(Reason::COUNT); ++idx) {
+				if(counters.counts[idx]) {
+					fprintf(out, " %s=%lu", reason_name(static_cast<Reason>(idx)), counters.counts[idx]);
+				}
+			}
+			fprintf(out, "\n");
+		}
+	}
+
+protected:
+
+	/**
+	 * Parse the headers of a copy of @frame from the beginning, the frame itself might point to the payload.
+	 */
+	Flow flow_of(const pcap::Frame& frame) noexcept {
+		Flow flow{};
+		_scratch.copy(frame);
+		_scratch.head_move_back(_scratch.offset());
+		_scratch.tail_move(_scratch.padding());
+
+		IpFrameParser parser(_scratch);
+		proto_ip::Protocol proto = parser.protocol();
+		while(proto != proto_ip::Protocol::END) {
+			if(proto == proto_ip::Protocol::L3_IPv4) {
+				const proto_ip::IPv4::Header* hdr;
+				if(_scratch.assign_stay(hdr)) {
+					flow.family = AF_INET;
+					memcpy(flow.addr, &hdr->daddr, sizeof(hdr->daddr));
+				}
+			} else if(proto == proto_ip::Protocol::L3_IPv6) {
+				const proto_ip::IPv6::Header* hdr;
+				if(_scratch.assign_stay(hdr)) {
+					flow.family = AF_INET6;
+					memcpy(flow.addr, &hdr->dst, sizeof(flow.addr));
+				}
+			} else if(proto == proto_ip::Protocol::L4_UDP) {
+				const proto_ip::Udp::Header* hdr;
+				if(_scratch.assign_stay(hdr)) {
+					flow.port = ntohs(hdr->dest);
+				}
+			}
+			proto = parser.next();
+		}
+		return flow;
+	}
+
+};
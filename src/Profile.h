@@ -0,0 +1,212 @@
+#pragma once
+
+/**
+ * The cycle counters of the hot path stages, built with -DSIMBA_PROFILE only:
+ *
+ *   bool load(Frame& frame) noexcept {
+ *       SIMBA_PROFILE_SPAN(Io);
+ *       ...
+ *   }
+ *   SIMBA_PROFILE_CALL(Output, handler.on_frame(frame));
+ *
+ * A span counts the TSC cycles from its construction to the end of the scope excluding the nested spans,
+ * so the stages add up to the total. Every thread accumulates the per-stage histograms in the thread local storage,
+ * they are merged at the thread exit and printed to stderr at the process exit.
+ * Without SIMBA_PROFILE the macro expands to nothing, the code is the same as without the spans.
+ */
+#ifndef SIMBA_PROFILE
+
+#define SIMBA_PROFILE_SPAN(stage)
+#define SIMBA_PROFILE_CALL(stage, call) call
+
+#else
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <x86intrin.h>
+
+namespace profile {
+
+enum class Stage : uint8_t {
+	Io,       // reading the frames
+	Ip,       // the L2-L4 headers
+	Dispatch, // the SIMBA packet and message headers
+	Decode,   // the message bodies
+	Output,   // the handler callbacks
+	COUNT
+};
+
+inline const char* stage_name(Stage stage) noexcept {
+	switch(stage) {
+		case Stage::Io: return "io";
+		case Stage::Ip: return "ip";
+		case Stage::Dispatch: return "dispatch";
+		case Stage::Decode: return "decode";
+		case Stage::Output: return "output";
+		default: return "unknown";
+	}
+}
+
+/**
+ * The cycles of a stage, the bucket N counts the spans of [2^(N-1), 2^N) cycles.
+ */
+struct Histogram {
+	static constexpr size_t BUCKETS = 65u;
+
+	uint64_t spans;
+	uint64_t cycles;
+	uint64_t max;
+	uint64_t buckets[BUCKETS];
+
+	inline void add(uint64_t value) noexcept {
+		spans++;
+		cycles += value;
+		max = value > max ? value : max;
+		buckets[value ? 64u - uint32_t(__builtin_clzll(value)) : 0u]++;
+	}
+
+	void merge(const Histogram& other) noexcept {
+		spans += other.spans;
+		cycles += other.cycles;
+		max = other.max > max ? other.max : max;
+		for(size_t idx = 0; idx < BUCKETS; ++idx) {
+			buckets[idx] += other.buckets[idx];
+		}
+	}
+
+	/**
+	 * @return The upper bound of the bucket of the percentile.
+	 */
+	uint64_t percentile(double p) const noexcept {
+		const uint64_t rank = uint64_t(double(spans) * p / 100.0);
+		uint64_t seen = 0;
+		for(size_t idx = 0; idx < BUCKETS; ++idx) {
+			seen += buckets[idx];
+			if(seen > rank) {
+				return idx < 64u ? (1ull << idx) - 1u : UINT64_MAX;
+			}
+		}
+		return 0;
+	}
+};
+
+struct Stages {
+	Histogram stages[size_t(Stage::COUNT)];
+
+	void merge(const Stages& other) noexcept {
+		for(size_t idx = 0; idx < size_t(Stage::COUNT); ++idx) {
+			stages[idx].merge(other.stages[idx]);
+		}
+	}
+};
+
+/**
+ * The totals of the exited threads, printed by the destructor.
+ */
+class Registry {
+	std::mutex _mutex;
+	Stages _total{};
+	size_t _threads = 0;
+
+public:
+
+	static Registry& instance() noexcept {
+		static Registry registry;
+		return registry;
+	}
+
+	void merge(const Stages& stages) noexcept {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_total.merge(stages);
+		_threads++;
+	}
+
+	~Registry() noexcept {
+		dump(stderr);
+	}
+
+	void dump(FILE* out) noexcept {
+		std::lock_guard<std::mutex> lock(_mutex);
+		uint64_t total = 0;
+		for(const Histogram& h : _total.stages) {
+			total += h.cycles;
+		}
+		// The packets are counted by the spans of the SIMBA packets.
+		const uint64_t packets = _total.stages[size_t(Stage::Dispatch)].spans;
+		fprintf(out, "Profile [ threads=%zu packets=%lu cycles=%lu ]\n", _threads, packets, total);
+		fprintf(out, "  %-10s %12s %16s %8s %12s %8s %8s %8s %12s\n", "stage", "spans", "cycles", "share",
+		        "cycles/pkt", "p50", "p90", "p99", "max");
+		for(size_t idx = 0; idx < size_t(Stage::COUNT); ++idx) {
+			const Histogram& h = _total.stages[idx];
+			if(h.spans == 0) {
+				continue;
+			}
+			fprintf(out, "  %-10s %12lu %16lu %7.2f%% %12.1f %8lu %8lu %8lu %12lu\n", stage_name(Stage(idx)),
+			        h.spans, h.cycles, total ? 100.0 * double(h.cycles) / double(total) : 0.0,
+			        packets ? double(h.cycles) / double(packets) : 0.0,
+			        h.percentile(50.0), h.percentile(90.0), h.percentile(99.0), h.max);
+		}
+	}
+};
+
+/**
+ * The counters of a thread, merged into the registry at the thread exit.
+ */
+struct ThreadStages {
+	Stages stages{};
+
+	ThreadStages() noexcept {
+		Registry::instance(); // the registry outlives the thread local counters of the main thread
+	}
+
+	~ThreadStages() noexcept {
+		Registry::instance().merge(stages);
+	}
+};
+
+inline thread_local ThreadStages thread_stages;
+
+class Span;
+inline thread_local Span* current_span = nullptr;
+
+class Span {
+	const Stage _stage;
+	Span* const _parent;
+	uint64_t _nested; // the cycles of the nested spans
+	const uint64_t _start;
+
+public:
+
+	Span(const Span&) = delete;
+	Span& operator=(const Span&) = delete;
+
+	explicit Span(Stage stage) noexcept :
+		_stage(stage),
+		_parent(current_span),
+		_nested(0),
+		_start(__rdtsc()) {
+		current_span = this;
+	}
+
+	~Span() noexcept {
+		unsigned int aux;
+		const uint64_t elapsed = __rdtscp(&aux) - _start;
+		thread_stages.stages.stages[size_t(_stage)].add(elapsed > _nested ? elapsed - _nested : 0);
+		if(_parent) {
+			_parent->_nested += elapsed;
+		}
+		current_span = _parent;
+	}
+};
+
+}; // namespace profile
+
+#define SIMBA_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SIMBA_PROFILE_CONCAT(a, b) SIMBA_PROFILE_CONCAT_IMPL(a, b)
+#define SIMBA_PROFILE_SPAN(stage) \
+	profile::Span SIMBA_PROFILE_CONCAT(simba_profile_span_, __LINE__)(profile::Stage::stage)
+#define SIMBA_PROFILE_CALL(stage, call) \
+	do { SIMBA_PROFILE_SPAN(stage); call; } while(false)
+
+#endif // SIMBA_PROFILE
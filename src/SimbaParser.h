@@ -1,66 +1,141 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <type_traits>
 
 #include "simba/simba.h"
+#include "simba/Handler.h"
+#include "simba/DumpHandler.h"
+#include "simba/SecurityFilter.h"
 #include "pcap/Frame.h"
-
+#include "ErrorLog.h"
+#include "Profile.h"
+
+/**
+ * SimbaParser decodes a SIMBA packet and passes the decoded structures to a handler.
+ * See simba::Handler for the call sequence.
+ * Nothing is printed on a malformed packet, error() and detail() tell the reason.
+ * The order messages of the securities which are not accepted by the filter are skipped before the handler
+ * is called for their headers.
+ */
 class SimbaParser {
 protected:
 	pcap::Frame& _frame;
+	simba::SecurityFilter* const _filter;
+	ErrorLog::Reason _error;
+	uint32_t _detail;
 
 public:
 
-	SimbaParser(pcap::Frame& frame) noexcept :
-		_frame(frame) {}
+	/**
+	 * @param filter - the securities to decode the messages of, nullptr - all of them.
+	 */
+	SimbaParser(pcap::Frame& frame, simba::SecurityFilter* filter = nullptr) noexcept :
+		_frame(frame),
+		_filter(filter),
+		_error(ErrorLog::Reason::COUNT),
+		_detail(0) {}
+
+	/**
+	 * @return The reason of the last parse() failure.
+	 */
+	inline ErrorLog::Reason error() const noexcept {
+		return _error;
+	}
+
+	/**
+	 * @return The reason specific value, see ErrorLog::Reason.
+	 */
+	inline uint32_t detail() const noexcept {
+		return _detail;
+	}
+
+	bool dump(output::TextBuffer& out) noexcept {
+		simba::DumpHandler handler(out);
+		return parse(handler);
+	}
 
-	bool dump(FILE* out) {
+	/**
+	 * Decode the packet the frame head points to.
+	 * @param handler - a simba::Handler descendant to pass the decoded structures to.
+	 * @return false - in case of a malformed packet.
+	 */
+	template <typename Handler>
+	bool parse(Handler& handler) noexcept {
+		SIMBA_PROFILE_SPAN(Dispatch);
 		bool result = false;
 		const simba::MarketDataPacketHeader* market_data_header;
 
-		_frame.dump(out);
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 		if(assign(market_data_header)) {
 
-			market_data_header->dump(out);
+			SIMBA_PROFILE_CALL(Output, handler.on_packet_header(*market_data_header));
 			if(market_data_header->has_flag(simba::MarketDataPacketHeader::Flags::IncrementalPacket)) {
-				result = dump_incremental(out);
+				result = parse_incremental(handler);
 			} else {
-				result = dump_sbe_message(out);
+				result = parse_sbe_message(handler);
 			}
+		} else {
+			fail(ErrorLog::Reason::PacketHeader);
+		}
+		return result;
+	}
+
+	/**
+	 * Read simba::MarketDataPacketHeader without moving the head.
+	 * @param frame - a frame, the head points to the packet.
+	 * @param header - a variable to read to.
+	 * @return true - if the frame is long enough to contain the header.
+	 */
+	static inline bool peek(pcap::Frame& frame, simba::MarketDataPacketHeader& header) noexcept {
+		const simba::MarketDataPacketHeader* pointer;
+		bool result = frame.assign_stay(pointer);
+		if(result) {
+			header = *pointer;
+#if __BYTE_ORDER == __BIG_ENDIAN
+			header.swap_endian();
+#endif
 		}
 		return result;
 	}
 
 protected:
 
-	bool dump_incremental(FILE* out) noexcept {
+	template <typename Handler>
+	bool parse_incremental(Handler& handler) noexcept {
 		bool result = false;
 		simba::IncrementalHeader* incremental_header;
 
-		_frame.dump(out);
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 		if(assign(incremental_header)) {
-			incremental_header->dump(out);
-			result = dump_sbe_message(out);
+			SIMBA_PROFILE_CALL(Output, handler.on_incremental_header(*incremental_header));
+			result = parse_sbe_message(handler);
 
 			while(_frame.available() && result) {
-				result = dump_sbe_message(out);
+				result = parse_sbe_message(handler);
 			}
 
 		} else {
-			fprintf(stderr, "simba::IncrementalHeader is missed.");
+			fail(ErrorLog::Reason::IncrementalHeader);
 		}
 
 		return result;
 	}
 
-	bool dump_sbe_message(FILE* out) noexcept {
+	template <typename Handler>
+	bool parse_sbe_message(Handler& handler) noexcept {
 		bool result = false;
 
 		const simba::SBEMessageHeader* sbe_header;
 
-		_frame.dump(out);
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 		if(assign(sbe_header)) {
-			sbe_header->dump(out);
+			if(_filter && skip_filtered(*sbe_header, result)) {
+				return result;
+			}
+			SIMBA_PROFILE_CALL(Output, handler.on_message_header(*sbe_header));
 
 			if(sbe_header->schema_id == simba::SchemaId::Default) {
 				switch(sbe_header->template_id) {
@@ -69,14 +144,23 @@ protected:
 					case simba::TemplateId::Logout:
 					case simba::TemplateId::Heartbeat:
 					case simba::TemplateId::SequenceReset:
-					case simba::TemplateId::EmptyBook:
-					case simba::TemplateId::SecurityStatus:
 					case simba::TemplateId::SecurityDefinitionUpdateReport:
-					case simba::TemplateId::TradingSessionStatus:
 					case simba::TemplateId::MarketDataRequest:
 						result = skip_message(*sbe_header);
 						break;
 
+					case simba::TemplateId::EmptyBook:
+						result = parse_status<simba::EmptyBook>(handler, *sbe_header);
+						break;
+
+					case simba::TemplateId::SecurityStatus:
+						result = parse_status<simba::SecurityStatus>(handler, *sbe_header);
+						break;
+
+					case simba::TemplateId::TradingSessionStatus:
+						result = parse_status<simba::TradingSessionStatus>(handler, *sbe_header);
+						break;
+
 					case simba::TemplateId::SecurityDefinition:
 					case simba::TemplateId::BestPrices:
 					case simba::TemplateId::DiscreteAuction:
@@ -84,104 +168,181 @@ protected:
 						break;
 
 					case simba::TemplateId::OrderUpdate:
-						result = dump_message<simba::OrderUpdate>(out, *sbe_header);
+						result = parse_message<simba::OrderUpdate>(handler, *sbe_header);
 						break;
 
 					case simba::TemplateId::OrderExecution:
-						result = dump_message<simba::OrderExecution>(out, *sbe_header);
+						result = parse_message<simba::OrderExecution>(handler, *sbe_header);
 						break;
 
 					case simba::TemplateId::OrderBookSnapshot:
-						result = dump_message_with_entry<simba::OrderBookSnapshotRoot, simba::OrderBookSnapshotEntry>(
-							out, *sbe_header);
+						result = parse_message_with_entry<simba::OrderBookSnapshotRoot, simba::OrderBookSnapshotEntry>(
+							handler, *sbe_header);
 						break;
 
 					default:
-						fprintf(stderr, "Unknown template id %u \n", static_cast<uint16_t>(sbe_header->template_id));
+						fail(ErrorLog::Reason::UnknownTemplate, static_cast<uint16_t>(sbe_header->template_id));
 						break;
 				}
+			} else {
+				fail(ErrorLog::Reason::UnknownSchema, static_cast<uint16_t>(sbe_header->schema_id));
 			}
 		} else {
-			fprintf(stderr, "simba::SBEMessageHeader is missed.");
+			fail(ErrorLog::Reason::MessageHeader);
 		}
 
 		return result;
 	}
 
-	template <typename Header>
-	bool dump_message(FILE* out, const simba::SBEMessageHeader& sbe_header) noexcept {
+	template <typename Header, typename Handler>
+	bool parse_message(Handler& handler, const simba::SBEMessageHeader& sbe_header) noexcept {
+		SIMBA_PROFILE_SPAN(Decode);
 		Header* header;
 
 		if(sbe_header.block_length != sizeof(*header)) {
-			fprintf(stderr, "SBEMessageHeader::BlockLength mismatch!");
-			fprintf(stderr, " block_length=%u", sbe_header.block_length);
-			fprintf(stderr, " expected=%zu\n", sizeof(*header));
-			return false;
+			return fail(ErrorLog::Reason::BlockLength, sbe_header.block_length);
 		}
 
-		_frame.dump(out);
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 		if(not assign(header)) {
-			fprintf(stderr, "The header is missed.");
-			return false;
+			return fail(ErrorLog::Reason::MessageBody);
 		}
 
-		header->dump(out);
+		deliver(handler, *header);
 		return true;
 
 	}
 
-	template <typename Header, typename Entry>
-	bool dump_message_with_entry(FILE* out, const simba::SBEMessageHeader& sbe_header) noexcept {
+	/**
+	 * Decode a status message, the fields appended by the later schema versions are skipped
+	 * and a shorter block is skipped as before the message was decoded.
+	 */
+	template <typename Message, typename Handler>
+	bool parse_status(Handler& handler, const simba::SBEMessageHeader& sbe_header) noexcept {
+		Message* msg;
+
+		if(sbe_header.block_length < sizeof(*msg)) {
+			return skip_message(sbe_header);
+		}
+
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
+		if(not assign(msg)) {
+			return fail(ErrorLog::Reason::MessageBody);
+		}
+		if(not _frame.head_move(sbe_header.block_length - sizeof(*msg))) {
+			return fail(ErrorLog::Reason::BlockLength, sbe_header.block_length);
+		}
+
+		deliver(handler, *msg);
+		return true;
+	}
+
+	template <typename Header, typename Entry, typename Handler>
+	bool parse_message_with_entry(Handler& handler, const simba::SBEMessageHeader& sbe_header) noexcept {
+		SIMBA_PROFILE_SPAN(Decode);
 		Header* header;
 		simba::GroupSize* group_size;
 		Entry* entry;
 
 		if(sbe_header.block_length != sizeof(*header)) {
-			fprintf(stderr, "SBEMessageHeader::BlockLength mismatch!");
-			fprintf(stderr, " block_length=%u", sbe_header.block_length);
-			fprintf(stderr, " expected=%zu\n", sizeof(*header));
-			return false;
+			return fail(ErrorLog::Reason::BlockLength, sbe_header.block_length);
 		}
 
-		_frame.dump(out);
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 		if(not assign(header)) {
-			fprintf(stderr, "The header is missed.");
-			return false;
+			return fail(ErrorLog::Reason::MessageBody);
 		}
-		header->dump(out);
+		deliver(handler, *header);
 
-		_frame.dump(out);
+		SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 		if(not assign(group_size)) {
-			fprintf(stderr, "simba::GroupSize is missed.");
-			return false;
+			return fail(ErrorLog::Reason::GroupSize);
 		}
 
 		const size_t expected_size = group_size->block_length * group_size->num_in_group;
 		if(expected_size > _frame.available()) {
-			fprintf(stderr, "simba::GroupSize::BlockLength mismatch.");
-			fprintf(stderr, " available=%zu", _frame.available());
-			fprintf(stderr, " expected=%zu\n", expected_size);
-			return false;
+			return fail(ErrorLog::Reason::GroupLength, uint32_t(expected_size));
+		}
+		SIMBA_PROFILE_CALL(Output, handler.on_group_size(*group_size));
+
+		if constexpr(std::is_same<Entry, simba::OrderBookSnapshotEntry>::value && Handler::SNAPSHOT_COLUMNS) {
+			if(group_size->block_length == sizeof(Entry)) {
+				simba::SnapshotColumns columns;
+				columns.decode(_frame.head(), group_size->num_in_group);
+				SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
+				_frame.head_move(expected_size);
+				SIMBA_PROFILE_CALL(Output, handler.on_snapshot_columns(columns));
+				return true;
+			}
 		}
-		group_size->dump(out);
 
 		for(simba::uInt8 grp_idx = 0; grp_idx < group_size->num_in_group; ++grp_idx) {
-			_frame.dump(out);
+			SIMBA_PROFILE_CALL(Output, handler.on_frame(_frame));
 			if(assign(entry)) {
-				entry->dump(out);
+				deliver(handler, *entry);
 			}
 		}
 
 		return true;
 	}
 
+	/**
+	 * Skip an order or status message of a security which is not accepted by the filter.
+	 * @param result - false in case of a malformed message.
+	 * @return false - the message is to be decoded.
+	 */
+	bool skip_filtered(const simba::SBEMessageHeader& sbe_header, bool& result) noexcept {
+		if(sbe_header.schema_id != simba::SchemaId::Default) {
+			return false;
+		}
+		switch(sbe_header.template_id) {
+			case simba::TemplateId::OrderUpdate:
+				return skip_filtered<simba::OrderUpdate>(sbe_header, result);
+
+			case simba::TemplateId::OrderExecution:
+				return skip_filtered<simba::OrderExecution>(sbe_header, result);
+
+			case simba::TemplateId::OrderBookSnapshot:
+				if(skip_filtered<simba::OrderBookSnapshotRoot>(sbe_header, result)) {
+					result = result && skip_entry();
+					return true;
+				}
+				return false;
+
+			case simba::TemplateId::SecurityStatus:
+				return skip_filtered<simba::SecurityStatus, false>(sbe_header, result);
+
+			default:
+				return false;
+		}
+	}
+
+	/**
+	 * @tparam EXACT - the block is of the message size, otherwise it might be longer, see parse_status().
+	 */
+	template <typename Message, bool EXACT = true>
+	bool skip_filtered(const simba::SBEMessageHeader& sbe_header, bool& result) noexcept {
+		constexpr size_t OFFSET = offsetof(Message, security_id);
+		if((EXACT ? sbe_header.block_length != sizeof(Message) : sbe_header.block_length < sizeof(Message))
+		   || _frame.available() < sizeof(Message)) {
+			return false; // reported by the decoding
+		}
+		int32_t security_id;
+		memcpy(&security_id, _frame.head() + OFFSET, sizeof(security_id));
+#if __BYTE_ORDER == __BIG_ENDIAN
+		security_id = int32_t(__builtin_bswap32(uint32_t(security_id)));
+#endif
+		if(_filter->accept(security_id)) {
+			return false;
+		}
+		result = skip_message(sbe_header);
+		return true;
+	}
+
 	bool skip_message(const simba::SBEMessageHeader& sbe_header) {
 		bool result = _frame.head_move(sbe_header.block_length);
 		if(not result) {
-			fprintf(stderr, "SBEMessageHeader::BlockLength mismatch!");
-			fprintf(stderr, " block_length=%u", sbe_header.block_length);
-			fprintf(stderr, " available=%zu\n", _frame.available());
-			return false;
+			return fail(ErrorLog::Reason::BlockLength, sbe_header.block_length);
 		}
 		return result;
 	}
@@ -189,16 +350,12 @@ protected:
 	bool skip_entry() {
 		simba::GroupSize* group_size;
 		if(not assign(group_size)) {
-			fprintf(stderr, "simba::GroupSize is missed.");
-			return false;
+			return fail(ErrorLog::Reason::GroupSize);
 		}
 
 		const size_t expected_size = group_size->block_length * group_size->num_in_group;
 		if(expected_size > _frame.available()) {
-			fprintf(stderr, "simba::GroupSize::BlockLength mismatch.");
-			fprintf(stderr, " available=%zu", _frame.available());
-			fprintf(stderr, " expected=%zu\n", expected_size);
-			return false;
+			return fail(ErrorLog::Reason::GroupLength, uint32_t(expected_size));
 		}
 
 		_frame.head_move(expected_size);
@@ -206,6 +363,47 @@ protected:
 		return true;
 	}
 
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::OrderUpdate& msg) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_order_update(msg));
+	}
+
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::OrderExecution& msg) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_order_execution(msg));
+	}
+
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::OrderBookSnapshotRoot& msg) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_snapshot_root(msg));
+	}
+
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::OrderBookSnapshotEntry& entry) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_snapshot_entry(entry));
+	}
+
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::EmptyBook& msg) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_empty_book(msg));
+	}
+
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::SecurityStatus& msg) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_security_status(msg));
+	}
+
+	template <typename Handler>
+	static inline void deliver(Handler& handler, const simba::TradingSessionStatus& msg) noexcept {
+		SIMBA_PROFILE_CALL(Output, handler.on_trading_session_status(msg));
+	}
+
+	inline bool fail(ErrorLog::Reason reason, uint32_t detail = 0) noexcept {
+		_error = reason;
+		_detail = detail;
+		return false;
+	}
+
 	template<typename V>
 	inline bool assign(V*& pointer) noexcept {
 		bool result = _frame.assign(pointer);
@@ -217,5 +415,3 @@ protected:
 		return result;
 	}
 };
-
-
@@ -0,0 +1,480 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <getopt.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "pcap/Frame.h"
+#include "IpFrameParser.h"
+#include "SimbaParser.h"
+#include "simba/RecordHandler.h"
+#include "gen/MarketGenerator.h"
+
+struct BenchOptions {
+	size_t packets = 4096;      // the packet set, every pass goes through all of them
+	size_t passes = 16;         // the passes per repetition
+	size_t repetitions = 10;
+	size_t warmup = 2;          // the passes before the measurement
+	gen::MarketConfig market;
+	uint8_t vlans = 0;
+	const char* stage = nullptr; // run only the stage
+	const char* results = nullptr;
+	const char* label = "";
+};
+
+/**
+ * A generated packet loaded into its own frame, the UDP payload location is found once.
+ */
+struct Packet {
+	std::unique_ptr<pcap::Frame> frame;
+	size_t size;
+	size_t payload_offset;
+	size_t payload_size;
+};
+
+struct Result {
+	const char* stage;
+	double ns_median; // per packet
+	double ns_min;
+	double ns_stddev;
+	double messages_per_second;
+	double cycles_per_message;
+};
+
+static const char* STAGES[] = {"frame_assign", "ip_parse", "simba_decode", "snapshot_columns", "text_dump", "csv_records",
+                               "pipeline"};
+
+static volatile uint64_t sink;
+
+static inline uint64_t cycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+/**
+ * Sums the decoded fields, so the decoding is not optimized away.
+ */
+struct SumHandler : public simba::Handler {
+	uint64_t sum = 0;
+
+	inline void on_order_update(const simba::OrderUpdate& msg) noexcept {
+		sum += uint64_t(msg.md_entry_id) + uint64_t(msg.md_entry_px._value) + uint64_t(msg.md_entry_size);
+	}
+
+	inline void on_order_execution(const simba::OrderExecution& msg) noexcept {
+		sum += uint64_t(msg.md_entry_id) + uint64_t(msg.last_px._value) + uint64_t(msg.last_qty);
+	}
+
+	inline void on_snapshot_entry(const simba::OrderBookSnapshotEntry& entry) noexcept {
+		sum += uint64_t(entry.md_entry_px._value) + uint64_t(entry.md_entry_size._value);
+	}
+
+	inline void on_empty_book(const simba::EmptyBook& msg) noexcept {
+		sum += msg.last_msg_seq_num_processed;
+	}
+
+	inline void on_security_status(const simba::SecurityStatus& msg) noexcept {
+		sum += uint64_t(msg.security_id) + uint64_t(msg.security_trading_status);
+	}
+
+	inline void on_trading_session_status(const simba::TradingSessionStatus& msg) noexcept {
+		sum += uint64_t(msg.trading_session_id) + uint64_t(msg.trad_ses_status);
+	}
+};
+
+/**
+ * Sums the same fields of the snapshot entries decoded into the columns.
+ */
+struct ColumnSumHandler : public SumHandler {
+	static constexpr bool SNAPSHOT_COLUMNS = true;
+
+	inline void on_snapshot_columns(const simba::SnapshotColumns& columns) noexcept {
+		for(size_t idx = 0; idx < columns.count; ++idx) {
+			sum += uint64_t(columns.md_entry_px[idx]) + uint64_t(columns.md_entry_size[idx]);
+		}
+	}
+};
+
+static inline bool extract_udp_payload(pcap::Frame& frame) noexcept {
+	IpFrameParser parser(frame);
+	auto proto = parser.protocol();
+	while(proto != proto_ip::Protocol::END) {
+		proto = parser.next();
+		if(proto == proto_ip::Protocol::L4_UDP) {
+			parser.next();
+			return true;
+		}
+	}
+	return false;
+}
+
+static inline void reset_frame(Packet& packet) noexcept {
+	packet.frame->reset(packet.size, 0);
+}
+
+static inline void reset_payload(Packet& packet) noexcept {
+	packet.frame->reset(packet.payload_offset + packet.payload_size, 0);
+	packet.frame->head_move(packet.payload_offset);
+}
+
+bool generate(const BenchOptions& opt, std::vector<Packet>& packets, uint64_t& messages) noexcept {
+	gen::Endpoint endpoint;
+	endpoint.vlans = opt.vlans;
+	gen::PacketBuilder builder(endpoint);
+	gen::MarketGenerator market(opt.market);
+	uint64_t time = 1600000000000000000ull;
+
+	packets.reserve(opt.packets);
+	for(size_t idx = 0; idx < opt.packets; ++idx) {
+		time += 1000u;
+		market.next(builder, time);
+		Packet packet{std::unique_ptr<pcap::Frame>(new pcap::Frame()), 0, 0, 0};
+		const uint8_t* data = builder.finish(packet.size);
+		memcpy(packet.frame->begin(), data, packet.size);
+
+		reset_frame(packet);
+		if(not extract_udp_payload(*packet.frame)) {
+			fprintf(stderr, "The generated packet %zu is not a UDP packet\n", idx);
+			return false;
+		}
+		packet.payload_offset = packet.frame->offset();
+		packet.payload_size = packet.frame->available();
+		packets.push_back(std::move(packet));
+	}
+	messages = market.messages();
+	return true;
+}
+
+/**
+ * Run @stage over all the packets 'warmup' times, then measure 'repetitions' of 'passes'.
+ * @param stage - a callable 'uint64_t(Packet&)'.
+ */
+template <typename Fn>
+Result measure(const char* name, std::vector<Packet>& packets, uint64_t messages, const BenchOptions& opt,
+               Fn&& stage) noexcept {
+	uint64_t sum = 0;
+	for(size_t pass = 0; pass < opt.warmup; ++pass) {
+		for(Packet& packet : packets) {
+			sum += stage(packet);
+		}
+	}
+
+	std::vector<double> ns(opt.repetitions);
+	std::vector<double> tsc(opt.repetitions);
+	for(size_t rep = 0; rep < opt.repetitions; ++rep) {
+		const auto start = std::chrono::steady_clock::now();
+		const uint64_t start_cycles = cycles();
+		for(size_t pass = 0; pass < opt.passes; ++pass) {
+			for(Packet& packet : packets) {
+				sum += stage(packet);
+			}
+		}
+		const uint64_t elapsed_cycles = cycles() - start_cycles;
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count();
+		ns[rep] = double(elapsed) / double(packets.size() * opt.passes);
+		tsc[rep] = double(elapsed_cycles) / double(messages * opt.passes);
+	}
+	sink = sum;
+
+	double mean = 0;
+	for(double value : ns) {
+		mean += value;
+	}
+	mean /= double(ns.size());
+	double variance = 0;
+	for(double value : ns) {
+		variance += (value - mean) * (value - mean);
+	}
+
+	std::sort(ns.begin(), ns.end());
+	std::sort(tsc.begin(), tsc.end());
+	Result result;
+	result.stage = name;
+	result.ns_median = ns[ns.size() / 2u];
+	result.ns_min = ns.front();
+	result.ns_stddev = std::sqrt(variance / double(ns.size()));
+	result.messages_per_second = double(messages) / double(packets.size()) * 1e9 / result.ns_median;
+	result.cycles_per_message = tsc[tsc.size() / 2u];
+	return result;
+}
+
+void usage(FILE* out, const char* name) noexcept {
+	fprintf(out, "usage: %s [options]\n", name);
+	fprintf(out, "  --packets=N          the generated packets (default 4096)\n");
+	fprintf(out, "  --passes=N           the passes through the packets per repetition (default 16)\n");
+	fprintf(out, "  --repetitions=N      the measured repetitions (default 10)\n");
+	fprintf(out, "  --warmup=N           the passes before the measurement (default 2)\n");
+	fprintf(out, "  --securities=N       the securities of the generated messages (default 16)\n");
+	fprintf(out, "  --max-messages=N     the maximum messages per incremental packet (default 8)\n");
+	fprintf(out, "  --executions=PCT     the percent of OrderExecution among the incremental messages (default 20)\n");
+	fprintf(out, "  --snapshot-every=N   a snapshot packet per N incremental packets, 0 - none (default 100)\n");
+	fprintf(out, "  --status-every=N     a SecurityStatus packet per N incremental packets, 0 - none (default 0)\n");
+	fprintf(out, "  --session-every=N    an EmptyBook and TradingSessionStatus packet per N incremental packets (default 0)\n");
+	fprintf(out, "  --vlans=N            the stacked VLAN tags of the frames (default 0)\n");
+	fprintf(out, "  --seed=N             the random seed (default 1)\n");
+	fprintf(out, "  --stage=NAME         run only the stage:");
+	for(const char* name : STAGES) {
+		fprintf(out, " %s", name);
+	}
+	fprintf(out, "\n");
+	fprintf(out, "  --results=FILE       append the results as CSV to FILE\n");
+	fprintf(out, "  --label=TEXT         the label of the results, e.g. the commit\n");
+}
+
+bool parse_options(int argc, char** argv, BenchOptions& opt) noexcept {
+	enum {
+		OPT_PACKETS = 256,
+		OPT_PASSES,
+		OPT_REPETITIONS,
+		OPT_WARMUP,
+		OPT_SECURITIES,
+		OPT_MAX_MESSAGES,
+		OPT_EXECUTIONS,
+		OPT_SNAPSHOT_EVERY,
+		OPT_STATUS_EVERY,
+		OPT_SESSION_EVERY,
+		OPT_VLANS,
+		OPT_SEED,
+		OPT_STAGE,
+		OPT_RESULTS,
+		OPT_LABEL,
+	};
+
+	static const option long_options[] = {
+		{"packets", required_argument, nullptr, OPT_PACKETS},
+		{"passes", required_argument, nullptr, OPT_PASSES},
+		{"repetitions", required_argument, nullptr, OPT_REPETITIONS},
+		{"warmup", required_argument, nullptr, OPT_WARMUP},
+		{"securities", required_argument, nullptr, OPT_SECURITIES},
+		{"max-messages", required_argument, nullptr, OPT_MAX_MESSAGES},
+		{"executions", required_argument, nullptr, OPT_EXECUTIONS},
+		{"snapshot-every", required_argument, nullptr, OPT_SNAPSHOT_EVERY},
+		{"status-every", required_argument, nullptr, OPT_STATUS_EVERY},
+		{"session-every", required_argument, nullptr, OPT_SESSION_EVERY},
+		{"vlans", required_argument, nullptr, OPT_VLANS},
+		{"seed", required_argument, nullptr, OPT_SEED},
+		{"stage", required_argument, nullptr, OPT_STAGE},
+		{"results", required_argument, nullptr, OPT_RESULTS},
+		{"label", required_argument, nullptr, OPT_LABEL},
+		{"help", no_argument, nullptr, 'h'},
+		{nullptr, 0, nullptr, 0}
+	};
+
+	int c;
+	while((c = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+		switch(c) {
+			case OPT_PACKETS:
+				opt.packets = strtoull(optarg, nullptr, 10);
+				if(opt.packets == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_PASSES:
+				opt.passes = strtoull(optarg, nullptr, 10);
+				if(opt.passes == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_REPETITIONS:
+				opt.repetitions = strtoull(optarg, nullptr, 10);
+				if(opt.repetitions == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_WARMUP:
+				opt.warmup = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_SECURITIES:
+				opt.market.securities = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_MAX_MESSAGES:
+				opt.market.max_messages = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_EXECUTIONS:
+				opt.market.execution_weight = uint32_t(strtoul(optarg, nullptr, 10));
+				if(opt.market.execution_weight > 100u) {
+					return false;
+				}
+				opt.market.update_weight = 100u - opt.market.execution_weight;
+				break;
+
+			case OPT_SNAPSHOT_EVERY:
+				opt.market.snapshot_every = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_STATUS_EVERY:
+				opt.market.status_every = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_SESSION_EVERY:
+				opt.market.session_every = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_VLANS:
+				opt.vlans = uint8_t(strtoul(optarg, nullptr, 10));
+				if(opt.vlans > gen::PacketBuilder::MAX_VLANS) {
+					return false;
+				}
+				break;
+
+			case OPT_SEED:
+				opt.market.seed = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_STAGE:
+				opt.stage = optarg;
+				if(std::none_of(std::begin(STAGES), std::end(STAGES),
+				                [](const char* name) { return strcmp(name, optarg) == 0; })) {
+					fprintf(stderr, "Unknown stage '%s'\n", optarg);
+					return false;
+				}
+				break;
+
+			case OPT_RESULTS:
+				opt.results = optarg;
+				break;
+
+			case OPT_LABEL:
+				opt.label = optarg;
+				break;
+
+			default:
+				return false;
+		}
+	}
+	return optind == argc;
+}
+
+int main(int argc, char** argv) noexcept {
+	BenchOptions opt;
+	if(not parse_options(argc, argv, opt)) {
+		usage(stderr, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Packet> packets;
+	uint64_t messages = 0;
+	if(not generate(opt, packets, messages)) {
+		return EXIT_FAILURE;
+	}
+	size_t bytes = 0;
+	for(const Packet& packet : packets) {
+		bytes += packet.size;
+	}
+	printf("packets=%zu messages=%lu bytes=%zu passes=%zu repetitions=%zu warmup=%zu\n",
+	       packets.size(), messages, bytes, opt.passes, opt.repetitions, opt.warmup);
+
+	output::TextBuffer text(-1, 1u << 20u);
+	simba::RecordFormats formats;
+	simba::parse_record_formats("OrderUpdate:csv", formats); // a single table, the way a stream output is accepted
+	simba::StreamOutput stream(text);
+	simba::RecordHandler<> records(stream, formats);
+
+	std::vector<Result> results;
+	const auto run = [&](const char* name, auto&& stage) {
+		if(not opt.stage || strcmp(opt.stage, name) == 0) {
+			results.push_back(measure(name, packets, messages, opt, stage));
+		}
+	};
+
+	run("frame_assign", [](Packet& packet) {
+		reset_frame(packet);
+		pcap::Frame& frame = *packet.frame;
+		const proto_ip::Ethernet::Header* eth;
+		const proto_ip::IPv4::Header* ip;
+		const proto_ip::Udp::Header* udp;
+		const simba::MarketDataPacketHeader* header;
+		uint64_t sum = frame.assign(eth) && frame.assign(ip) && frame.assign(udp) && frame.assign(header);
+		return sum + frame.offset();
+	});
+
+	run("ip_parse", [](Packet& packet) {
+		reset_frame(packet);
+		return uint64_t(extract_udp_payload(*packet.frame)) + packet.frame->offset();
+	});
+
+	run("simba_decode", [](Packet& packet) {
+		reset_payload(packet);
+		SumHandler handler;
+		SimbaParser parser(*packet.frame);
+		return uint64_t(parser.parse(handler)) + handler.sum;
+	});
+
+	run("snapshot_columns", [](Packet& packet) {
+		reset_payload(packet);
+		ColumnSumHandler handler;
+		SimbaParser parser(*packet.frame);
+		return uint64_t(parser.parse(handler)) + handler.sum;
+	});
+
+	run("text_dump", [&text](Packet& packet) {
+		reset_payload(packet);
+		SimbaParser parser(*packet.frame);
+		const uint64_t result = uint64_t(parser.dump(text)) + text.size();
+		text.clear();
+		return result;
+	});
+
+	run("csv_records", [&text, &records](Packet& packet) {
+		reset_payload(packet);
+		SimbaParser parser(*packet.frame);
+		const uint64_t result = uint64_t(parser.parse(records)) + text.size();
+		text.clear();
+		return result;
+	});
+
+	run("pipeline", [&text](Packet& packet) {
+		reset_frame(packet);
+		uint64_t result = 0;
+		if(extract_udp_payload(*packet.frame)) {
+			SimbaParser parser(*packet.frame);
+			result = uint64_t(parser.dump(text)) + text.size();
+			text.clear();
+		}
+		return result;
+	});
+
+	printf("%-16s %12s %12s %12s %14s %12s\n", "stage", "ns/packet", "min", "stddev", "messages/s", "cycles/msg");
+	for(const Result& r : results) {
+		printf("%-16s %12.1f %12.1f %12.2f %14.0f %12.1f\n", r.stage, r.ns_median, r.ns_min, r.ns_stddev,
+		       r.messages_per_second, r.cycles_per_message);
+	}
+
+	if(opt.results) {
+		FILE* file = fopen(opt.results, "a");
+		if(not file) {
+			fprintf(stderr, "'%s' : fopen() failed: %s\n", opt.results, strerror(errno));
+			return EXIT_FAILURE;
+		}
+		if(ftell(file) == 0) {
+			fprintf(file, "label,stage,packets,messages,bytes,repetitions,ns_per_packet,ns_per_packet_min,"
+			              "ns_per_packet_stddev,messages_per_second,cycles_per_message\n");
+		}
+		for(const Result& r : results) {
+			fprintf(file, "%s,%s,%zu,%lu,%zu,%zu,%.2f,%.2f,%.3f,%.0f,%.2f\n", opt.label, r.stage, packets.size(),
+			        messages, bytes, opt.repetitions, r.ns_median, r.ns_min, r.ns_stddev, r.messages_per_second,
+			        r.cycles_per_message);
+		}
+		fclose(file);
+	}
+
+	return EXIT_SUCCESS;
+}
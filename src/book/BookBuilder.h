@@ -0,0 +1,465 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+
+#include "../simba/Handler.h"
+#include "OrderBook.h"
+#include "DepthView.h"
+#include "SecurityMap.h"
+
+namespace book {
+
+/**
+ * The book state of a single security.
+ */
+struct Security {
+	int32_t id;
+	uint32_t idx;         // The dense index, see SecurityMap and BookBuilder(..., idx_offset, idx_stride).
+	uint32_t rpt_seq;     // The last applied 'rpt_seq'.
+	uint64_t update_time; // The 'sending_time' of the last applied packet.
+	uint32_t generation;  // The BookBuilder generation the book belongs to, an older book and depth are cleared on access.
+	const uint32_t* builder_generation; // The current generation of the BookBuilder.
+	simba::SecurityTradingStatus trading_status; // The last SecurityStatus, 'Null' - unknown.
+	bool recovering;      // There was an 'rpt_seq' gap, the book is empty until a snapshot is applied.
+	OrderBook book;
+	DepthView depth;
+
+	Security(int32_t security_id, uint32_t security_idx, size_t depth_levels, OrderBook::Pool& pool,
+	         const uint32_t& current_generation) noexcept :
+		id(security_id),
+		idx(security_idx),
+		rpt_seq(0),
+		update_time(0),
+		generation(current_generation),
+		builder_generation(&current_generation),
+		trading_status(simba::SecurityTradingStatus::Null),
+		recovering(false),
+		book(pool),
+		depth(depth_levels) {}
+
+	/**
+	 * @return The orders of the book, 0 if it has been emptied by EmptyBook and is not cleared yet.
+	 */
+	inline size_t orders() const noexcept {
+		return generation == *builder_generation ? book.orders() : 0u;
+	}
+
+	inline bool halted() const noexcept {
+		return trading_status == simba::SecurityTradingStatus::TradingHalt
+		       || trading_status == simba::SecurityTradingStatus::InstrumentHalt;
+	}
+};
+
+/**
+ * A listener for the books without subscribers.
+ */
+struct NoListener {
+	inline void on_book_update(Security&, const DepthView::Changes&) noexcept {}
+	inline void on_book_cleared(Security&) noexcept {}
+};
+
+/**
+ * BookBuilder is a simba::Handler which maintains L3 books and L2 depth views of all the securities.
+ *
+ * Incremental messages with 'rpt_seq' not greater than the last applied one are ignored.
+ * A gap in 'rpt_seq' empties the book and the security is recovering: its incrementals are dropped until
+ * the next snapshot, which is applied whatever its 'rpt_seq'. Otherwise a snapshot is applied only if it is
+ * newer than the book, so a capture might contain both incremental and snapshot feeds.
+ *
+ * EmptyBook is the session boundary: all the books are cleared and 'rpt_seq' starts over. The builder generation
+ * is bumped and the book and the depth view of an older generation are cleared the next time the security
+ * is accessed, Security::orders() doesn't count the orders meanwhile. EmptyBook resets 'rpt_seq' and notifies
+ * the listener once per security which had levels, it is O(1) per security.
+ * SecurityStatus and TradingSessionStatus are tracked, they don't change the books.
+ *
+ * @listener is notified with the "levels changed" bitmask every time the top levels of a book change
+ * and once a book with levels is emptied by EmptyBook, the depth view is not read by the latter:
+ *   listener.on_book_update(security, changes)
+ *   listener.on_book_cleared(security)
+ **/
+template <typename Listener = NoListener>
+class BookBuilder : public simba::Handler {
+public:
+
+	static constexpr bool SNAPSHOT_COLUMNS = true;
+
+	struct Stats {
+		uint64_t updates;        // incremental messages applied
+		uint64_t stale;          // incremental messages ignored by 'rpt_seq'
+		uint64_t unknown_orders; // updates of orders which are not in the book
+		uint64_t gaps;           // 'rpt_seq' gaps
+		uint64_t dropped;        // incremental messages dropped while recovering from a gap
+		uint64_t snapshots;      // snapshots applied
+		uint64_t empty_books;    // EmptyBook messages, i.e. all the books cleared
+		uint64_t mass_cancels;   // orders deleted with the 'MassCancel' flag
+	};
+
+protected:
+	Listener& _listener;
+	const size_t _depth;
+	const uint32_t _idx_offset;
+	const uint32_t _idx_stride;
+	OrderBook::Pool _pool;   // The orders of all the books, it outlives the books.
+	SecurityMap _map;
+	std::deque<Security> _securities;
+	uint16_t _packet_flags;
+	uint64_t _sending_time;
+	Security* _snapshot;     // The security the current snapshot is applied to.
+	uint32_t _snapshot_left; // Entries left in the current snapshot group.
+	uint32_t _generation;    // Bumped by EmptyBook, see Security::generation.
+	int32_t _trading_session_id;
+	simba::TradSesStatus _trad_ses_status;
+	Stats _stats;
+
+public:
+
+	BookBuilder(const BookBuilder&) = delete;
+	BookBuilder& operator=(const BookBuilder&) = delete;
+
+	/**
+	 * @param listener - book updates listener.
+	 * @param depth - the number of levels per side in the depth views.
+	 * @param idx_offset, idx_stride - Security::idx is 'idx_offset + local_idx * idx_stride',
+	 *   so several builders (see ShardedBookBuilder) produce unique indexes.
+	 */
+	BookBuilder(Listener& listener, size_t depth, uint32_t idx_offset = 0, uint32_t idx_stride = 1) noexcept :
+		_listener(listener),
+		_depth(depth),
+		_idx_offset(idx_offset),
+		_idx_stride(idx_stride),
+		_pool(),
+		_map(),
+		_securities(),
+		_packet_flags(0),
+		_sending_time(0),
+		_snapshot(nullptr),
+		_snapshot_left(0),
+		_generation(1),
+		_trading_session_id(0),
+		_trad_ses_status(),
+		_stats() {}
+
+	inline size_t size() const noexcept {
+		return _securities.size();
+	}
+
+	inline Security& security(size_t idx) noexcept {
+		return current(_securities[idx]);
+	}
+
+	/**
+	 * @return The security state or nullptr.
+	 */
+	inline Security* find(int32_t security_id) noexcept {
+		const uint32_t idx = _map.find(security_id);
+		return idx == SecurityMap::NONE ? nullptr : &current(_securities[idx]);
+	}
+
+	inline const Stats& stats() const noexcept {
+		return _stats;
+	}
+
+	/**
+	 * @return The last TradingSessionStatus 'trading_session_id', 0 - unknown.
+	 */
+	inline int32_t trading_session_id() const noexcept {
+		return _trading_session_id;
+	}
+
+	inline simba::TradSesStatus trad_ses_status() const noexcept {
+		return _trad_ses_status;
+	}
+
+	/**
+	 * @return The security the current snapshot is applied to or nullptr.
+	 */
+	inline const Security* snapshot() const noexcept {
+		return _snapshot;
+	}
+
+	/**
+	 * Restore the state of a security saved by a checkpoint, the orders are added to the returned book.
+	 * The securities MUST be restored in the order of their indexes into an empty builder.
+	 */
+	Security& restore(int32_t security_id, uint32_t rpt_seq, uint64_t update_time, bool recovering) noexcept {
+		Security& sec = get(security_id);
+		sec.book.clear();
+		sec.rpt_seq = rpt_seq;
+		sec.update_time = update_time;
+		sec.recovering = recovering;
+		return sec;
+	}
+
+	/**
+	 * Complete the restoring: the depth views are rebuilt and the listener is notified of all the levels.
+	 * @param snapshot - a snapshot was in progress, @snapshot_id is the security it is applied to.
+	 * @param trading_session_id, trad_ses_status - the last TradingSessionStatus.
+	 */
+	void restored(const Stats& stats, uint64_t sending_time, bool snapshot, int32_t snapshot_id,
+	              int32_t trading_session_id, simba::TradSesStatus trad_ses_status) noexcept {
+		_stats = stats;
+		_sending_time = sending_time;
+		_trading_session_id = trading_session_id;
+		_trad_ses_status = trad_ses_status;
+		_snapshot = snapshot ? find(snapshot_id) : nullptr;
+		for(Security& sec : _securities) {
+			sec.depth.reset(sec.book);
+			const DepthView::Changes changes = sec.depth.take_changes();
+			if(not changes.empty()) {
+				_listener.on_book_update(sec, changes);
+			}
+		}
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "BookBuilder [");
+		fprintf(out, " securities=%zu", _securities.size());
+		fprintf(out, " updates=%lu", _stats.updates);
+		fprintf(out, " stale=%lu", _stats.stale);
+		fprintf(out, " unknown_orders=%lu", _stats.unknown_orders);
+		fprintf(out, " gaps=%lu", _stats.gaps);
+		fprintf(out, " dropped=%lu", _stats.dropped);
+		fprintf(out, " snapshots=%lu", _stats.snapshots);
+		fprintf(out, " empty_books=%lu", _stats.empty_books);
+		fprintf(out, " mass_cancels=%lu", _stats.mass_cancels);
+		size_t halted = 0;
+		size_t recovering = 0;
+		for(const Security& sec : _securities) {
+			halted += sec.halted();
+			recovering += sec.recovering;
+		}
+		fprintf(out, " halted=%zu recovering=%zu", halted, recovering);
+		if(_trading_session_id) {
+			fprintf(out, " trading_session_id=%d trad_ses_status=%s", _trading_session_id,
+			        simba::trad_ses_status_name(_trad_ses_status));
+		}
+		// The memory of the live orders: the pool slabs and the order indexes of the books.
+		size_t orders = 0;
+		size_t bytes = _pool.bytes();
+		for(const Security& sec : _securities) {
+			orders += sec.orders();
+			bytes += sec.book.index_bytes();
+		}
+		fprintf(out, " orders=%zu order_bytes=%zu bytes_per_order=%.1f", orders, bytes,
+		        orders ? double(bytes) / double(orders) : 0.0);
+		fprintf(out, " ]\n");
+	}
+
+	// simba::Handler
+
+	inline void on_packet_header(const simba::MarketDataPacketHeader& header) noexcept {
+		_packet_flags = header.msg_flags;
+		_sending_time = header.sending_time;
+	}
+
+	void on_order_update(const simba::OrderUpdate& msg) noexcept {
+		Security& sec = get(msg.security_id);
+		if(not accept(sec, msg.rpt_seq)) {
+			return;
+		}
+
+		Side side;
+		if(not side_of(msg.md_entry_type, side)) {
+			return;
+		}
+
+		bool known = true;
+		switch(msg.md_update_action) {
+			case simba::MDUpdateAction::New:
+				known = sec.book.add(msg.md_entry_id, side, msg.md_entry_px._value, msg.md_entry_size, sec.depth);
+				break;
+
+			case simba::MDUpdateAction::Change:
+				known = sec.book.modify(msg.md_entry_id, msg.md_entry_px._value, msg.md_entry_size, sec.depth);
+				break;
+
+			case simba::MDUpdateAction::Delete:
+				known = sec.book.remove(msg.md_entry_id, sec.depth);
+				_stats.mass_cancels += (msg.md_flags >> static_cast<uint8_t>(simba::MDFlagsBits::MassCancel)) & 1u;
+				break;
+		}
+		updated(sec, known);
+	}
+
+	void on_order_execution(const simba::OrderExecution& msg) noexcept {
+		Security& sec = get(msg.security_id);
+		if(not accept(sec, msg.rpt_seq)) {
+			return;
+		}
+
+		bool known = false;
+		const OrderBook::Order* order = sec.book.find(msg.md_entry_id);
+		if(order) {
+			if(msg.md_update_action == simba::MDUpdateAction::Delete || msg.md_entry_size.is_null()) {
+				known = sec.book.remove(msg.md_entry_id, sec.depth);
+			} else {
+				known = sec.book.modify(msg.md_entry_id, order->price, msg.md_entry_size._value, sec.depth);
+			}
+		}
+		updated(sec, known);
+	}
+
+	void on_snapshot_root(const simba::OrderBookSnapshotRoot& msg) noexcept {
+		Security& sec = get(int32_t(msg.security_id));
+		const bool start = (_packet_flags & snapshot_flag(simba::MarketDataPacketHeader::Flags::StartOfSnapshot)) != 0;
+
+		if(start) {
+			_snapshot = nullptr;
+			if(sec.recovering || msg.rpt_seq > sec.rpt_seq) {
+				sec.book.clear();
+				sec.recovering = false;
+				sec.rpt_seq = msg.rpt_seq;
+				sec.update_time = _sending_time;
+				_snapshot = &sec;
+				_stats.snapshots++;
+			}
+		} else if(_snapshot != &sec) {
+			_snapshot = nullptr;
+		}
+	}
+
+	inline void on_group_size(const simba::GroupSize& group) noexcept {
+		_snapshot_left = group.num_in_group;
+		if(_snapshot && _snapshot_left == 0) {
+			snapshot_done();
+		}
+	}
+
+	void on_snapshot_entry(const simba::OrderBookSnapshotEntry& entry) noexcept {
+		if(_snapshot == nullptr) {
+			return;
+		}
+
+		Side side;
+		if(side_of(entry.md_entry_type, side) && not entry.md_entry_id.is_null()
+		   && not entry.md_entry_px.is_null() && not entry.md_entry_size.is_null()) {
+			NoObserver observer;
+			_snapshot->book.add(entry.md_entry_id._value, side, entry.md_entry_px._value, entry.md_entry_size._value, observer);
+		}
+
+		if(--_snapshot_left == 0) {
+			snapshot_done();
+		}
+	}
+
+	void on_snapshot_columns(const simba::SnapshotColumns& columns) noexcept {
+		if(_snapshot == nullptr || columns.count == 0) {
+			return;
+		}
+
+		NoObserver observer;
+		for(size_t idx = 0; idx < columns.count; ++idx) {
+			Side side;
+			if(columns.orders[idx] && side_of(columns.md_entry_type[idx], side)) {
+				_snapshot->book.add(columns.md_entry_id[idx], side, columns.md_entry_px[idx], columns.md_entry_size[idx],
+				                    observer);
+			}
+		}
+
+		_snapshot_left -= uint32_t(columns.count);
+		if(_snapshot_left == 0) {
+			snapshot_done();
+		}
+	}
+
+	void on_empty_book(const simba::EmptyBook&) noexcept {
+		_generation++;
+		_snapshot = nullptr;
+		_stats.empty_books++;
+		for(Security& sec : _securities) {
+			sec.rpt_seq = 0;
+			sec.recovering = false;
+			const bool cleared = sec.generation + 1u == _generation; // not emptied by an earlier EmptyBook yet
+			if(cleared && (sec.depth.level(Side::Bid, 0).count || sec.depth.level(Side::Ask, 0).count)) {
+				_listener.on_book_cleared(sec);
+			}
+		}
+	}
+
+	inline void on_security_status(const simba::SecurityStatus& msg) noexcept {
+		get(msg.security_id).trading_status = msg.security_trading_status;
+	}
+
+	inline void on_trading_session_status(const simba::TradingSessionStatus& msg) noexcept {
+		_trading_session_id = msg.trading_session_id;
+		_trad_ses_status = msg.trad_ses_status;
+	}
+
+protected:
+
+	static inline constexpr uint16_t snapshot_flag(simba::MarketDataPacketHeader::Flags flag) noexcept {
+		return uint16_t(1u << static_cast<uint16_t>(flag));
+	}
+
+	inline Security& get(int32_t security_id) noexcept {
+		const uint32_t idx = _map.insert(security_id);
+		if(idx == _securities.size()) {
+			_securities.emplace_back(security_id, _idx_offset + idx * _idx_stride, _depth, _pool, _generation);
+		}
+		return current(_securities[idx]);
+	}
+
+	/**
+	 * Clear the book and the depth view of @sec if they have been emptied by EmptyBook since the last access,
+	 * the listener has been notified by EmptyBook.
+	 */
+	inline Security& current(Security& sec) noexcept {
+		if(sec.generation != _generation) {
+			sec.book.clear();
+			sec.depth.clear();
+			sec.depth.take_changes();
+			sec.generation = _generation;
+		}
+		return sec;
+	}
+
+	inline bool accept(Security& sec, uint32_t rpt_seq) noexcept {
+		if(rpt_seq <= sec.rpt_seq) {
+			_stats.stale++;
+			return false;
+		}
+		const bool gap = sec.rpt_seq && rpt_seq != sec.rpt_seq + 1u;
+		sec.rpt_seq = rpt_seq;
+		sec.update_time = _sending_time;
+		if(gap && not sec.recovering) {
+			_stats.gaps++;
+			sec.recovering = true;
+			sec.book.clear();
+			sec.depth.clear();
+			notify(sec);
+		}
+		if(sec.recovering) {
+			_stats.dropped++;
+			return false;
+		}
+		return true;
+	}
+
+	inline void updated(Security& sec, bool known) noexcept {
+		_stats.updates++;
+		if(not known) {
+			_stats.unknown_orders++;
+		}
+		notify(sec);
+	}
+
+	inline void notify(Security& sec) noexcept {
+		const DepthView::Changes changes = sec.depth.take_changes();
+		if(not changes.empty()) {
+			_listener.on_book_update(sec, changes);
+		}
+	}
+
+	inline void snapshot_done() noexcept {
+		_snapshot->depth.reset(_snapshot->book);
+		const DepthView::Changes changes = _snapshot->depth.take_changes();
+		if(not changes.empty()) {
+			_listener.on_book_update(*_snapshot, changes);
+		}
+	}
+
+};
+
+}; // namespace book
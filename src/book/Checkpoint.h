@@ -0,0 +1,370 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <dirent.h>
+
+#include "../pcap/MappedFile.h"
+#include "../pcap/Reader.h"
+#include "BookBuilder.h"
+
+namespace book {
+
+/**
+ * The capture position of a checkpoint, it is taken between two frames.
+ */
+struct Position {
+	uint64_t file_offset;  // the capture file offset of the next frame
+	uint64_t frame_index;  // the index of the next frame
+	uint64_t capture_time; // the capture timestamp of the last frame
+	uint64_t sending_time; // the sending_time of the last packet
+	uint32_t msg_seq_num;  // the msg_seq_num of the last incremental packet
+};
+
+/**
+ * The identity of the capture a checkpoint is taken from, a checkpoint is not applied to another capture.
+ */
+struct Capture {
+	uint64_t file_size;
+	pcap::pcap_hdr pcap_header; // the global header as it is stored in the file
+	pcap::pcaprec_hdr record;   // the header of the frame at Position::file_offset, zeros at the end of the file
+
+	/**
+	 * @return The identity of the capture read by @reader at its current position.
+	 */
+	static Capture of(pcap::Reader& reader) noexcept {
+		Capture capture;
+		memset(&capture, 0, sizeof(capture));
+		capture.file_size = reader.file_size();
+		capture.pcap_header = reader.pcap_header();
+		if(not reader.peek_record(capture.record)) {
+			memset(&capture.record, 0, sizeof(capture.record));
+		}
+		return capture;
+	}
+};
+
+/**
+ * Checkpoint is a binary image of the BookBuilder state and the capture position:
+ *
+ *   Header | Record[securities] | Order[orders]
+ *
+ * The orders of a security follow the orders of the previous one. The fields are of the host byte order,
+ * the image is mapped back into memory and the books are rebuilt from it.
+ * The checkpoints of a directory are named 'checkpoint-<frame_index>.simba',
+ * a file is written under a temporary name and renamed, so a crash doesn't leave a partial checkpoint.
+ **/
+class Checkpoint {
+public:
+
+	static constexpr uint64_t MAGIC = 0x31504B4341424D53ull; // "SMBACKP1"
+	static constexpr uint32_t VERSION = 5u;
+
+	struct Header {
+		uint64_t magic;
+		uint32_t version;
+		uint32_t securities;
+		uint64_t orders;
+		Position position;
+		Capture capture;
+		uint32_t snapshot;    // 1 - a snapshot is in progress
+		int32_t snapshot_id;  // the security the snapshot is applied to
+		int32_t trading_session_id; // the last TradingSessionStatus
+		uint32_t trad_ses_status;   // simba::TradSesStatus
+		uint64_t updates;     // BookBuilder::Stats
+		uint64_t stale;
+		uint64_t unknown_orders;
+		uint64_t gaps;
+		uint64_t dropped;
+		uint64_t snapshots;
+		uint64_t empty_books;
+		uint64_t mass_cancels;
+	};
+
+	struct Record {
+		int32_t id;
+		uint32_t rpt_seq;
+		uint64_t update_time;
+		uint64_t orders;
+		uint32_t trading_status; // simba::SecurityTradingStatus
+		uint32_t recovering;     // 1 - waiting for a snapshot after a gap
+	};
+
+	struct Order {
+		int64_t id;
+		int64_t price;
+		int64_t size;
+		uint64_t side;        // book::Side
+	};
+
+protected:
+
+	pcap::MappedFile _file;
+	const Header* _header;
+
+public:
+
+	Checkpoint(const Checkpoint&) = delete;
+	Checkpoint& operator=(const Checkpoint&) = delete;
+
+	Checkpoint() noexcept : _file(), _header(nullptr) {}
+
+	inline const Header& header() const noexcept {
+		return *_header;
+	}
+
+	/**
+	 * Write the state of @builder into @dir.
+	 * @param capture - the identity of the capture at @position.
+	 * @return false - in case of any errors.
+	 */
+	template <typename Listener>
+	static bool save(const char* dir, BookBuilder<Listener>& builder, const Position& position,
+	                 const Capture& capture) noexcept {
+		Header header;
+		memset(&header, 0, sizeof(header));
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.securities = uint32_t(builder.size());
+		header.position = position;
+		header.capture = capture;
+		header.snapshot = builder.snapshot() != nullptr;
+		header.snapshot_id = builder.snapshot() ? builder.snapshot()->id : 0;
+		header.trading_session_id = builder.trading_session_id();
+		header.trad_ses_status = uint32_t(builder.trad_ses_status());
+		const auto& stats = builder.stats();
+		header.updates = stats.updates;
+		header.stale = stats.stale;
+		header.unknown_orders = stats.unknown_orders;
+		header.gaps = stats.gaps;
+		header.dropped = stats.dropped;
+		header.snapshots = stats.snapshots;
+		header.empty_books = stats.empty_books;
+		header.mass_cancels = stats.mass_cancels;
+		for(size_t idx = 0; idx < builder.size(); ++idx) {
+			header.orders += builder.security(idx).orders();
+		}
+
+		const std::string path = file_name(dir, position.frame_index);
+		const std::string temp = path + ".tmp";
+		FILE* file = fopen(temp.c_str(), "wb");
+		if(not file) {
+			fprintf(stderr, "'%s' : fopen() failed: %s\n", temp.c_str(), strerror(errno));
+			return false;
+		}
+		setvbuf(file, nullptr, _IOFBF, 1u << 20u);
+
+		bool result = fwrite(&header, sizeof(header), 1u, file) == 1u;
+		for(size_t idx = 0; idx < builder.size() && result; ++idx) {
+			const Security& sec = builder.security(idx);
+			const Record record{sec.id, sec.rpt_seq, sec.update_time, sec.orders(), uint32_t(sec.trading_status),
+			                     uint32_t(sec.recovering)};
+			result = fwrite(&record, sizeof(record), 1u, file) == 1u;
+		}
+		for(size_t idx = 0; idx < builder.size() && result; ++idx) {
+			builder.security(idx).book.for_each_order([&result, file](int64_t id, const OrderBook::Order& order) {
+				const Order saved{id, order.price, order.size, uint64_t(order.side)};
+				result = result && fwrite(&saved, sizeof(saved), 1u, file) == 1u;
+			});
+		}
+		result = fclose(file) == 0 && result;
+
+		if(result && rename(temp.c_str(), path.c_str()) != 0) {
+			fprintf(stderr, "'%s' : rename() failed: %s\n", path.c_str(), strerror(errno));
+			return false;
+		}
+		if(not result) {
+			fprintf(stderr, "'%s' : write failed\n", temp.c_str());
+			remove(temp.c_str());
+		}
+		return result;
+	}
+
+	/**
+	 * Map a checkpoint and validate it.
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* path) noexcept {
+		_header = nullptr;
+		if(not _file.open(path)) {
+			fprintf(stderr, "'%s' is not available for reading.\n", path);
+			return false;
+		}
+		const Header* header = reinterpret_cast<const Header*>(_file.data());
+		if(_file.size() < sizeof(Header) || header->magic != MAGIC || header->version != VERSION) {
+			fprintf(stderr, "'%s' is not a checkpoint.\n", path);
+			return false;
+		}
+		if(_file.size() != sizeof(Header) + header->securities * sizeof(Record) + header->orders * sizeof(Order)) {
+			fprintf(stderr, "'%s' : the checkpoint is truncated.\n", path);
+			return false;
+		}
+		const Record* records = reinterpret_cast<const Record*>(header + 1);
+		uint64_t orders = 0;
+		for(uint32_t idx = 0; idx < header->securities && orders <= header->orders; ++idx) {
+			orders += records[idx].orders;
+		}
+		if(orders != header->orders) {
+			fprintf(stderr, "'%s' : the orders of the securities don't match the header.\n", path);
+			return false;
+		}
+		_header = header;
+		return true;
+	}
+
+	/**
+	 * Move @reader to the checkpoint position, the capture MUST be the one the checkpoint is taken from.
+	 * @return false - in case of another capture or the position is out of the file.
+	 */
+	bool seek(pcap::Reader& reader) const noexcept {
+		const Position& position = _header->position;
+		const Capture& capture = _header->capture;
+		if(capture.file_size != reader.file_size()
+		   || memcmp(&capture.pcap_header, &reader.pcap_header(), sizeof(capture.pcap_header)) != 0) {
+			fprintf(stderr, "the checkpoint is taken from another capture.\n");
+			return false;
+		}
+		if(not reader.seek(position.file_offset, position.frame_index)) {
+			return false;
+		}
+		const Capture current = Capture::of(reader);
+		if(memcmp(&capture.record, &current.record, sizeof(capture.record)) != 0) {
+			fprintf(stderr, "the checkpoint is taken from another capture: the frame %lu doesn't match.\n",
+			        position.frame_index);
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Rebuild the state of an empty @builder, the listener is notified of all the levels.
+	 */
+	template <typename Listener>
+	void restore(BookBuilder<Listener>& builder) const noexcept {
+		const Record* records = reinterpret_cast<const Record*>(_header + 1);
+		const Order* orders = reinterpret_cast<const Order*>(records + _header->securities);
+		NoObserver observer;
+		for(uint32_t idx = 0; idx < _header->securities; ++idx) {
+			const Record& record = records[idx];
+			Security& sec = builder.restore(record.id, record.rpt_seq, record.update_time, record.recovering != 0);
+			sec.trading_status = simba::SecurityTradingStatus(record.trading_status);
+			for(uint64_t count = 0; count < record.orders; ++count, ++orders) {
+				sec.book.add(orders->id, Side(orders->side), orders->price, orders->size, observer);
+			}
+		}
+
+		typename BookBuilder<Listener>::Stats stats{};
+		stats.updates = _header->updates;
+		stats.stale = _header->stale;
+		stats.unknown_orders = _header->unknown_orders;
+		stats.gaps = _header->gaps;
+		stats.dropped = _header->dropped;
+		stats.snapshots = _header->snapshots;
+		stats.empty_books = _header->empty_books;
+		stats.mass_cancels = _header->mass_cancels;
+		builder.restored(stats, _header->position.sending_time, _header->snapshot != 0, _header->snapshot_id,
+		                 _header->trading_session_id, simba::TradSesStatus(_header->trad_ses_status));
+	}
+
+	/**
+	 * Find the latest checkpoint of @dir at or before @frame_index and @sending_time.
+	 * @param path - the path of the checkpoint found.
+	 * @return false - there is no such checkpoint.
+	 */
+	static bool find(const char* dir, uint64_t frame_index, uint64_t sending_time, std::string& path) noexcept {
+		DIR* handle = opendir(dir);
+		if(not handle) {
+			fprintf(stderr, "'%s' : opendir() failed: %s\n", dir, strerror(errno));
+			return false;
+		}
+
+		bool found = false;
+		uint64_t best = 0;
+		while(const dirent* entry = readdir(handle)) {
+			const size_t length = strlen(entry->d_name);
+			if(strncmp(entry->d_name, "checkpoint-", 11u) != 0 || length < 17u
+			   || strcmp(entry->d_name + length - 6u, ".simba") != 0) {
+				continue;
+			}
+			const std::string candidate = std::string(dir) + "/" + entry->d_name;
+			FILE* file = fopen(candidate.c_str(), "rb");
+			Header header;
+			const bool read = file && fread(&header, sizeof(header), 1u, file) == 1u;
+			if(file) {
+				fclose(file);
+			}
+			if(read && header.magic == MAGIC && header.version == VERSION
+			   && header.position.frame_index <= frame_index && header.position.sending_time <= sending_time
+			   && (not found || header.position.frame_index > best)) {
+				found = true;
+				best = header.position.frame_index;
+				path = candidate;
+			}
+		}
+		closedir(handle);
+		return found;
+	}
+
+	static std::string file_name(const char* dir, uint64_t frame_index) noexcept {
+		char name[64];
+		snprintf(name, sizeof(name), "/checkpoint-%012lu.simba", frame_index);
+		return std::string(dir) + name;
+	}
+
+	void dump(FILE* out) const noexcept {
+		const Position& position = _header->position;
+		fprintf(out, "Checkpoint [ frame_index=%lu file_offset=%lu sending_time=%lu capture_time=%lu msg_seq_num=%u"
+		        " securities=%u orders=%lu ]\n", position.frame_index, position.file_offset, position.sending_time,
+		        position.capture_time, position.msg_seq_num, _header->securities, _header->orders);
+	}
+
+};
+
+/**
+ * Checkpointer saves a checkpoint every 'interval' nanoseconds of sending_time.
+ */
+class Checkpointer {
+	const char* _dir;
+	const uint64_t _interval;
+	uint64_t _next;
+	uint64_t _written;
+	bool _failed;
+
+public:
+
+	Checkpointer(const char* dir, uint64_t interval) noexcept :
+		_dir(dir),
+		_interval(interval),
+		_next(0),
+		_written(0),
+		_failed(false) {}
+
+	/**
+	 * Save a checkpoint if the next interval has started, the first packet starts the intervals.
+	 * @return false - the checkpoint has failed, the later ones are not written.
+	 */
+	template <typename Listener>
+	bool after_packet(BookBuilder<Listener>& builder, const Position& position, pcap::Reader& reader) noexcept {
+		if(_failed) {
+			return false;
+		}
+		if(_next == 0) {
+			_next = (position.sending_time / _interval + 1u) * _interval;
+		} else if(position.sending_time >= _next) {
+			_failed = not Checkpoint::save(_dir, builder, position, Capture::of(reader));
+			_next = (position.sending_time / _interval + 1u) * _interval;
+			_written += not _failed;
+		}
+		return not _failed;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "Checkpointer [ dir=%s written=%lu failed=%d ]\n", _dir, _written, int(_failed));
+	}
+
+};
+
+}; // namespace book
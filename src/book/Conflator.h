@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include "TopOfBook.h"
+#include "../concurrent/SeqLock.h"
+#include "../concurrent/SpscRing.h"
+
+namespace book {
+
+/**
+ * Conflator decouples a slow consumer from the book builder.
+ * It is a BookBuilder listener (the producer side) which keeps only the latest TopOfBook of every security
+ * and a list of the securities changed since the consumer has seen them last time.
+ *
+ * A security is in the dirty list at most once, so the memory is bounded by the number of securities
+ * and the producer never waits for the consumer. The consumer drains the list at its own pace
+ * and always gets the freshest state of every changed security.
+ *
+ * The producer and the consumer might run on different threads (one thread per side).
+ **/
+class Conflator {
+public:
+
+	struct Stats {
+		uint64_t updates;   // book updates received
+		uint64_t conflated; // updates merged into an already dirty state
+		uint64_t overflows; // updates of securities beyond the capacity
+	};
+
+protected:
+	const uint32_t _capacity;
+	std::unique_ptr<concurrent::SeqLock<TopOfBook>[]> _states;
+	std::unique_ptr<std::atomic<bool>[]> _dirty;
+	concurrent::SpscRing<uint32_t> _dirty_list;
+	Stats _stats; // producer side
+	uint64_t _drained; // consumer side
+
+public:
+
+	Conflator(const Conflator&) = delete;
+	Conflator& operator=(const Conflator&) = delete;
+
+	/**
+	 * @param capacity - the maximum number of securities.
+	 */
+	explicit Conflator(uint32_t capacity) noexcept :
+		_capacity(capacity),
+		_states(new concurrent::SeqLock<TopOfBook>[capacity]),
+		_dirty(new std::atomic<bool>[capacity]),
+		_dirty_list(capacity),
+		_stats(),
+		_drained(0) {
+		for(uint32_t idx = 0; idx < capacity; ++idx) {
+			_states[idx].seq.store(0, std::memory_order_relaxed);
+			_dirty[idx].store(false, std::memory_order_relaxed);
+		}
+	}
+
+	// BookBuilder listener, the producer side.
+
+	void on_book_update(Security& sec, const DepthView::Changes& changes) noexcept {
+		if(not TopOfBook::affected(changes)) {
+			return;
+		}
+		publish(sec, [&sec](TopOfBook& tob) {
+			tob.assign(sec);
+		});
+	}
+
+	void on_book_cleared(Security& sec) noexcept {
+		publish(sec, [&sec](TopOfBook& tob) {
+			tob.clear(sec);
+		});
+	}
+
+	/**
+	 * The consumer side.
+	 * @param fn - a callable 'void(const TopOfBook&)'.
+	 * @param limit - the maximum number of states to pass to @fn.
+	 * @return The number of states passed to @fn.
+	 */
+	template <typename Fn>
+	size_t drain(Fn&& fn, size_t limit = SIZE_MAX) noexcept {
+		size_t result = 0;
+		uint32_t idx;
+		TopOfBook tob;
+		while(result < limit && _dirty_list.try_pop(idx)) {
+			// The flag is cleared before reading, so an update made after that puts the security back to the list.
+			_dirty[idx].exchange(false, std::memory_order_acq_rel);
+			_states[idx].read(tob);
+			fn(static_cast<const TopOfBook&>(tob));
+			result++;
+		}
+		_drained += result;
+		return result;
+	}
+
+	/**
+	 * The consumer side.
+	 * @return true - if there are no changed securities.
+	 */
+	inline bool empty() const noexcept {
+		return _dirty_list.empty();
+	}
+
+	inline const Stats& stats() const noexcept {
+		return _stats;
+	}
+
+	/**
+	 * MUST be called when both sides are stopped.
+	 */
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "Conflator [");
+		fprintf(out, " capacity=%u", _capacity);
+		fprintf(out, " updates=%lu", _stats.updates);
+		fprintf(out, " conflated=%lu", _stats.conflated);
+		fprintf(out, " drained=%lu", _drained);
+		fprintf(out, " overflows=%lu", _stats.overflows);
+		fprintf(out, " ]\n");
+	}
+
+protected:
+
+	/**
+	 * Store the state of @sec and queue it unless it is queued already.
+	 */
+	template <typename Fn>
+	void publish(const Security& sec, Fn&& fn) noexcept {
+		if(sec.idx >= _capacity) {
+			_stats.overflows++;
+			return;
+		}
+
+		_stats.updates++;
+		_states[sec.idx].update(fn);
+
+		if(_dirty[sec.idx].exchange(true, std::memory_order_acq_rel)) {
+			_stats.conflated++;
+		} else {
+			// The ring never overflows, every security is in the list at most once.
+			_dirty_list.push(sec.idx);
+		}
+	}
+
+};
+
+}; // namespace book
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "OrderBook.h"
+
+namespace book {
+
+/**
+ * DepthView is a L2 view of the top N price levels of an OrderBook.
+ * The view is an OrderBook observer, it is updated incrementally and accumulates
+ * a "levels changed" bitmask per side: bit 'i' is set if the level 'i' (0 - the best one) has changed.
+ *
+ * The mask is taken with 'take_changes()' after every book update, so subscribers
+ * only touch the levels which have actually changed.
+ **/
+class DepthView {
+public:
+
+	static constexpr size_t MAX_DEPTH = 32u;
+
+	struct Changes {
+		uint32_t bids;
+		uint32_t asks;
+
+		inline bool empty() const noexcept {
+			return (bids | asks) == 0u;
+		}
+	};
+
+protected:
+	Level _bids[MAX_DEPTH];
+	Level _asks[MAX_DEPTH];
+	uint32_t _depth;
+	Changes _changes;
+
+public:
+
+	/**
+	 * @param depth - the number of levels per side, MUST NOT be greater than MAX_DEPTH.
+	 */
+	explicit DepthView(size_t depth = 10u) noexcept :
+		_bids(),
+		_asks(),
+		_depth(uint32_t(depth < MAX_DEPTH ? depth : MAX_DEPTH)),
+		_changes{0u, 0u} {}
+
+	inline size_t depth() const noexcept {
+		return _depth;
+	}
+
+	/**
+	 * @return The level 'idx' of the side, the empty level has zero 'count'.
+	 */
+	inline const Level& level(Side side, size_t idx) const noexcept {
+		return side == Side::Bid ? _bids[idx] : _asks[idx];
+	}
+
+	/**
+	 * @return The accumulated changes and reset them.
+	 */
+	inline Changes take_changes() noexcept {
+		const Changes result = _changes;
+		_changes = Changes{0u, 0u};
+		return result;
+	}
+
+	/**
+	 * OrderBook observer.
+	 * @param structural - the level has been created or removed, the worse levels have been shifted.
+	 */
+	void on_level(const OrderBook& book, Side side, int64_t price, bool structural) noexcept {
+		const auto& levels = book.levels(side);
+		const auto less = levels.key_comp();
+
+		// The rank of the level is the number of the better levels.
+		uint32_t rank = 0;
+		auto it = levels.begin();
+		while(rank < _depth && it != levels.end() && less(it->first, price)) {
+			++it;
+			++rank;
+		}
+
+		if(rank < _depth) {
+			const uint32_t last = structural ? _depth : rank + 1u;
+			refresh(side, rank, last, it, levels.end());
+		}
+	}
+
+	/**
+	 * Rebuild the view completely, e.g. after the book has been cleared or a snapshot has been applied.
+	 */
+	void reset(const OrderBook& book) noexcept {
+		refresh(Side::Bid, 0, _depth, book.levels(Side::Bid).begin(), book.levels(Side::Bid).end());
+		refresh(Side::Ask, 0, _depth, book.levels(Side::Ask).begin(), book.levels(Side::Ask).end());
+	}
+
+	/**
+	 * Empty the view, e.g. when the book is going to be cleared.
+	 */
+	void clear() noexcept {
+		const OrderBook::Levels none(PriceOrder{false});
+		refresh(Side::Bid, 0, _depth, none.begin(), none.end());
+		refresh(Side::Ask, 0, _depth, none.begin(), none.end());
+	}
+
+	/**
+	 * Print the levels marked in @changes.
+	 */
+	void dump(FILE* out, const Changes& changes) const noexcept {
+		fprintf(out, "DepthView [");
+		dump_side(out, "bid", _bids, changes.bids);
+		dump_side(out, "ask", _asks, changes.asks);
+		fprintf(out, " ]\n");
+	}
+
+protected:
+
+	template <typename Iterator>
+	inline void refresh(Side side, uint32_t first, uint32_t last, Iterator it, Iterator end) noexcept {
+		Level* levels = side == Side::Bid ? _bids : _asks;
+		uint32_t& mask = side == Side::Bid ? _changes.bids : _changes.asks;
+
+		for(uint32_t idx = first; idx < last; ++idx) {
+			Level level{0, 0, 0u};
+			if(it != end) {
+				level = it->second;
+				++it;
+			}
+			if(levels[idx] != level) {
+				levels[idx] = level;
+				mask |= 1u << idx;
+			}
+		}
+	}
+
+	static void dump_side(FILE* out, const char* name, const Level* levels, uint32_t mask) noexcept {
+		while(mask) {
+			const uint32_t idx = __builtin_ctz(mask);
+			mask &= mask - 1u;
+			const Level& level = levels[idx];
+			if(level.count) {
+				fprintf(out, " %s[%u]=%f:%ld:%u", name, idx, double(level.price) / 100000, level.size, level.count);
+			} else {
+				fprintf(out, " %s[%u]=empty", name, idx);
+			}
+		}
+	}
+
+};
+
+}; // namespace book
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+
+#include "SlabPool.h"
+
+namespace book {
+
+enum class Side : uint8_t {
+	Bid,
+	Ask
+};
+
+/**
+ * @return The book side of simba::MDEntryType or false for the types which are not orders.
+ */
+inline bool side_of(char md_entry_type, Side& side) noexcept {
+	switch(md_entry_type) {
+		case '0':
+			side = Side::Bid;
+			return true;
+		case '1':
+			side = Side::Ask;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/**
+ * An aggregated price level.
+ */
+struct Level {
+	int64_t price; // Decimal5 mantissa
+	int64_t size;
+	uint32_t count;
+
+	inline bool operator==(const Level& other) const noexcept {
+		return price == other.price && size == other.size && count == other.count;
+	}
+
+	inline bool operator!=(const Level& other) const noexcept {
+		return not (*this == other);
+	}
+};
+
+/**
+ * Orders the price levels from the best one to the worst one.
+ */
+struct PriceOrder {
+	bool descending;
+
+	inline bool operator()(int64_t lhs, int64_t rhs) const noexcept {
+		return descending ? lhs > rhs : lhs < rhs;
+	}
+};
+
+/**
+ * A price level of OrderBook, the orders of the level are linked in the order of arrival.
+ */
+struct PriceLevel : Level {
+	uint32_t head; // SlabPool handles of the first and the last order
+	uint32_t tail;
+};
+
+/**
+ * OrderBook is a L3 (order by order) book of a single security.
+ *
+ * The orders are allocated from a SlabPool shared by the books of a BookBuilder and are indexed
+ * by an open addressing table of 32-bit handles, it never shrinks. A new order and an order
+ * which changes its price are queued at the end of the level.
+ *
+ * Every method which changes a price level notifies @observer with
+ *   observer.on_level(book, side, price, structural)
+ * where 'structural' is true if the level has been created or removed.
+ * It allows keeping aggregated views (see DepthView) up to date without rebuilding them.
+ **/
+class OrderBook {
+public:
+
+	using Levels = std::map<int64_t, PriceLevel, PriceOrder>;
+
+	struct Order {
+		int64_t id;    // md_entry_id
+		int64_t price; // Decimal5 mantissa
+		int64_t size;  // md_entry_size
+		uint32_t prev; // the orders of the level, the free list of the pool
+		uint32_t next;
+		Side side;
+	};
+
+	using Pool = SlabPool<Order>;
+	using Handle = Pool::Handle;
+
+	static constexpr Handle NONE = Pool::NONE;
+
+protected:
+	Pool& _pool;
+	std::unique_ptr<Handle[]> _index;
+	uint32_t _mask;
+	size_t _orders;
+	Levels _bids;
+	Levels _asks;
+
+public:
+
+	OrderBook(const OrderBook&) = delete;
+	OrderBook& operator=(const OrderBook&) = delete;
+
+	explicit OrderBook(Pool& pool) noexcept :
+		_pool(pool),
+		_index(),
+		_mask(0),
+		_orders(0),
+		_bids(PriceOrder{true}),
+		_asks(PriceOrder{false}) {
+		allocate(16u);
+	}
+
+	~OrderBook() noexcept {
+		release_orders();
+	}
+
+	inline const Levels& levels(Side side) const noexcept {
+		return side == Side::Bid ? _bids : _asks;
+	}
+
+	inline size_t orders() const noexcept {
+		return _orders;
+	}
+
+	/**
+	 * @return The bytes of the order index.
+	 */
+	inline size_t index_bytes() const noexcept {
+		return (size_t(_mask) + 1u) * sizeof(Handle);
+	}
+
+	inline const Order* find(int64_t id) const noexcept {
+		const Handle handle = _index[locate(id)];
+		return handle == NONE ? nullptr : &_pool[handle];
+	}
+
+	/**
+	 * @param fn - a callable 'void(int64_t id, const Order& order)',
+	 *             the orders are passed level by level in the order of arrival.
+	 */
+	template <typename Fn>
+	void for_each_order(Fn&& fn) const noexcept {
+		for(const Levels* levels : {&_bids, &_asks}) {
+			for(const auto& level : *levels) {
+				for(Handle handle = level.second.head; handle != NONE; handle = _pool[handle].next) {
+					fn(_pool[handle].id, _pool[handle]);
+				}
+			}
+		}
+	}
+
+	/**
+	 * Add a new order.
+	 * @return false - if the order already exists.
+	 */
+	template <typename Observer>
+	bool add(int64_t id, Side side, int64_t price, int64_t size, Observer& observer) noexcept {
+		uint32_t pos = locate(id);
+		if(_index[pos] != NONE) {
+			return false;
+		}
+		if((_orders + 1u) * 2u > size_t(_mask) + 1u) {
+			grow();
+			pos = locate(id);
+		}
+
+		const Handle handle = _pool.allocate();
+		Order& order = _pool[handle];
+		order.id = id;
+		order.price = price;
+		order.size = size;
+		order.side = side;
+		_index[pos] = handle;
+		_orders++;
+		level_add(handle, order, observer);
+		return true;
+	}
+
+	/**
+	 * Change the price and the size of an existing order.
+	 * @return false - if the order doesn't exist.
+	 */
+	template <typename Observer>
+	bool modify(int64_t id, int64_t price, int64_t size, Observer& observer) noexcept {
+		const Handle handle = _index[locate(id)];
+		if(handle == NONE) {
+			return false;
+		}
+		Order& order = _pool[handle];
+		if(order.price == price) {
+			level_change(order.side, price, size - order.size, observer);
+			order.size = size;
+		} else {
+			level_remove(order, observer);
+			order.price = price;
+			order.size = size;
+			level_add(handle, order, observer);
+		}
+		return true;
+	}
+
+	/**
+	 * Remove an existing order.
+	 * @return false - if the order doesn't exist.
+	 */
+	template <typename Observer>
+	bool remove(int64_t id, Observer& observer) noexcept {
+		const uint32_t pos = locate(id);
+		const Handle handle = _index[pos];
+		if(handle == NONE) {
+			return false;
+		}
+		level_remove(_pool[handle], observer);
+		erase(pos);
+		_pool.release(handle);
+		_orders--;
+		return true;
+	}
+
+	/**
+	 * Remove all the orders. The observer is not notified, the views have to be refreshed completely.
+	 */
+	void clear() noexcept {
+		release_orders();
+		std::fill(_index.get(), _index.get() + _mask + 1u, NONE);
+		_orders = 0;
+		_bids.clear();
+		_asks.clear();
+	}
+
+	void dump(FILE* out) const noexcept {
+		fprintf(out, "OrderBook [ orders=%zu bids=%zu asks=%zu ]\n", _orders, _bids.size(), _asks.size());
+	}
+
+protected:
+
+	static inline uint32_t hash(int64_t id) noexcept {
+		return uint32_t((uint64_t(id) * 0x9E3779B97F4A7C15ull) >> 32u);
+	}
+
+	/**
+	 * @return The slot of @id or the empty slot it would be inserted into.
+	 */
+	inline uint32_t locate(int64_t id) const noexcept {
+		uint32_t pos = hash(id) & _mask;
+		while(_index[pos] != NONE && _pool[_index[pos]].id != id) {
+			pos = (pos + 1u) & _mask;
+		}
+		return pos;
+	}
+
+	/**
+	 * Empty a slot shifting the following slots of the cluster back, so no tombstones are needed.
+	 */
+	void erase(uint32_t hole) noexcept {
+		uint32_t pos = (hole + 1u) & _mask;
+		while(_index[pos] != NONE) {
+			const uint32_t home = hash(_pool[_index[pos]].id) & _mask;
+			if(((pos - home) & _mask) >= ((pos - hole) & _mask)) {
+				_index[hole] = _index[pos];
+				hole = pos;
+			}
+			pos = (pos + 1u) & _mask;
+		}
+		_index[hole] = NONE;
+	}
+
+	void allocate(size_t slots) noexcept {
+		_index.reset(new Handle[slots]);
+		_mask = uint32_t(slots - 1u);
+		std::fill(_index.get(), _index.get() + slots, NONE);
+	}
+
+	void grow() noexcept {
+		std::unique_ptr<Handle[]> old(_index.release());
+		const size_t old_slots = size_t(_mask) + 1u;
+		allocate(old_slots * 2u);
+		for(size_t idx = 0; idx < old_slots; ++idx) {
+			if(old[idx] != NONE) {
+				uint32_t pos = hash(_pool[old[idx]].id) & _mask;
+				while(_index[pos] != NONE) {
+					pos = (pos + 1u) & _mask;
+				}
+				_index[pos] = old[idx];
+			}
+		}
+	}
+
+	void release_orders() noexcept {
+		for(uint32_t idx = 0; _orders && idx <= _mask; ++idx) {
+			if(_index[idx] != NONE) {
+				_pool.release(_index[idx]);
+			}
+		}
+	}
+
+	inline Levels& levels_mutable(Side side) noexcept {
+		return side == Side::Bid ? _bids : _asks;
+	}
+
+	template <typename Observer>
+	inline void level_add(Handle handle, Order& order, Observer& observer) noexcept {
+		const auto inserted = levels_mutable(order.side).emplace(order.price,
+		                                                        PriceLevel{{order.price, order.size, 1u}, handle, handle});
+		order.next = NONE;
+		if(inserted.second) {
+			order.prev = NONE;
+		} else {
+			PriceLevel& level = inserted.first->second;
+			level.size += order.size;
+			level.count++;
+			order.prev = level.tail;
+			_pool[level.tail].next = handle;
+			level.tail = handle;
+		}
+		observer.on_level(*this, order.side, order.price, inserted.second);
+	}
+
+	template <typename Observer>
+	inline void level_change(Side side, int64_t price, int64_t delta, Observer& observer) noexcept {
+		auto& levels = levels_mutable(side);
+		auto it = levels.find(price);
+		if(it != levels.end()) {
+			it->second.size += delta;
+			observer.on_level(*this, side, price, false);
+		}
+	}
+
+	template <typename Observer>
+	inline void level_remove(const Order& order, Observer& observer) noexcept {
+		auto& levels = levels_mutable(order.side);
+		auto it = levels.find(order.price);
+		if(it != levels.end()) {
+			PriceLevel& level = it->second;
+			const bool structural = --level.count == 0;
+			if(structural) {
+				levels.erase(it);
+			} else {
+				level.size -= order.size;
+				(order.prev == NONE ? level.head : _pool[order.prev].next) = order.next;
+				(order.next == NONE ? level.tail : _pool[order.next].prev) = order.prev;
+			}
+			observer.on_level(*this, order.side, order.price, structural);
+		}
+	}
+
+};
+
+/**
+ * An observer for the books without views.
+ */
+struct NoObserver {
+	inline void on_level(const OrderBook&, Side, int64_t, bool) noexcept {}
+};
+
+}; // namespace book
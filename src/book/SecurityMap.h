@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+namespace book {
+
+/**
+ * SecurityMap maps 'security_id' to a dense index [0, size()).
+ * The indexes are assigned in order of appearance and never change,
+ * so per-security state might be kept in plain arrays.
+ *
+ * It is an open addressing hash table with linear probing, it never shrinks.
+ **/
+class SecurityMap {
+
+	struct Slot {
+		int32_t id;
+		uint32_t idx; // NONE - the slot is empty
+	};
+
+public:
+
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+protected:
+	std::unique_ptr<Slot[]> _slots;
+	uint32_t _mask;
+	uint32_t _size;
+
+public:
+
+	SecurityMap(const SecurityMap&) = delete;
+	SecurityMap& operator=(const SecurityMap&) = delete;
+
+	explicit SecurityMap(uint32_t capacity = 1024u) noexcept :
+		_slots(),
+		_mask(0),
+		_size(0) {
+		uint32_t slots = 16u;
+		while(slots < capacity * 2u) {
+			slots <<= 1u;
+		}
+		allocate(slots);
+	}
+
+	inline uint32_t size() const noexcept {
+		return _size;
+	}
+
+	/**
+	 * @return The index of @id or NONE.
+	 */
+	inline uint32_t find(int32_t id) const noexcept {
+		uint32_t pos = hash(id) & _mask;
+		while(true) {
+			const Slot& slot = _slots[pos];
+			if(slot.idx == NONE || slot.id == id) {
+				return slot.idx;
+			}
+			pos = (pos + 1u) & _mask;
+		}
+	}
+
+	/**
+	 * @return The index of @id, a new index is assigned if @id is not known yet.
+	 */
+	inline uint32_t insert(int32_t id) noexcept {
+		uint32_t pos = hash(id) & _mask;
+		while(true) {
+			Slot& slot = _slots[pos];
+			if(slot.idx == NONE) {
+				slot.id = id;
+				slot.idx = _size++;
+				const uint32_t result = slot.idx;
+				if(_size * 2u > _mask) {
+					grow();
+				}
+				return result;
+			}
+			if(slot.id == id) {
+				return slot.idx;
+			}
+			pos = (pos + 1u) & _mask;
+		}
+	}
+
+protected:
+
+	static inline uint32_t hash(int32_t id) noexcept {
+		return uint32_t(id) * 0x9E3779B1u;
+	}
+
+	void allocate(uint32_t slots) noexcept {
+		_slots.reset(new Slot[slots]);
+		_mask = slots - 1u;
+		for(uint32_t i = 0; i < slots; ++i) {
+			_slots[i].idx = NONE;
+		}
+	}
+
+	void grow() noexcept {
+		std::unique_ptr<Slot[]> old(_slots.release());
+		const uint32_t old_slots = _mask + 1u;
+		allocate(old_slots * 2u);
+		for(uint32_t i = 0; i < old_slots; ++i) {
+			if(old[i].idx != NONE) {
+				uint32_t pos = hash(old[i].id) & _mask;
+				while(_slots[pos].idx != NONE) {
+					pos = (pos + 1u) & _mask;
+				}
+				_slots[pos] = old[i];
+			}
+		}
+	}
+
+};
+
+}; // namespace book
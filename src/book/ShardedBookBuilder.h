@@ -0,0 +1,353 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "BookBuilder.h"
+#include "../concurrent/Parker.h"
+#include "../concurrent/SpscRing.h"
+
+namespace book {
+
+/**
+ * ShardedBookBuilder is a simba::Handler which runs on the decode thread and routes the decoded messages
+ * to N book workers. A worker is chosen by a hash of 'security_id', so all the messages of a security
+ * are handled by the same worker in the decode order. Every worker owns a BookBuilder and
+ * a single-producer single-consumer ring.
+ *
+ *                       | ring | -> worker 0 (BookBuilder, listeners[0])
+ *   decode -> router -> | ring | -> worker 1 (BookBuilder, listeners[1])
+ *                       | ring | -> ...
+ *
+ * barrier() waits until the workers have applied everything routed before it, e.g. to observe a consistent
+ * state of all the books. The barrier might be set automatically after every message with
+ * the 'EndOfTransaction' flag.
+ *
+ * An idle worker and the decode thread waiting for a barrier spin for a while and then sleep on
+ * a concurrent::Parker, so the waiting threads don't take the cores.
+ **/
+template <typename Listener = NoListener>
+class ShardedBookBuilder : public simba::Handler {
+public:
+
+	/**
+	 * A decoded message passed to a worker.
+	 */
+	struct Message {
+		enum class Kind : uint8_t {
+			OrderUpdate,
+			OrderExecution,
+			SnapshotRoot,
+			GroupSize,
+			SnapshotEntry,
+			EmptyBook,
+			SecurityStatus,
+			TradingSessionStatus,
+			Barrier,
+			Stop
+		};
+
+		Kind kind;
+		uint16_t packet_flags;
+		uint64_t sending_time;
+		union {
+			simba::OrderUpdate update;
+			simba::OrderExecution execution;
+			simba::OrderBookSnapshotRoot root;
+			simba::GroupSize group;
+			simba::OrderBookSnapshotEntry entry;
+			simba::EmptyBook empty_book;
+			simba::TradingSessionStatus session;
+			struct {
+				int32_t security_id;
+				simba::SecurityTradingStatus security_trading_status;
+			} status; // the fields of SecurityStatus the builder uses
+		};
+	};
+
+protected:
+
+	struct Worker {
+		concurrent::SpscRing<Message> ring;
+		concurrent::Parker routed_event; // a message is pushed into the ring
+		BookBuilder<Listener> builder;
+		std::thread thread;
+		uint64_t routed; // decode thread side
+		alignas(concurrent::CACHE_LINE_SIZE) std::atomic<uint64_t> barriers; // the last barrier passed
+
+		Worker(size_t ring_capacity, Listener& listener, size_t depth, uint32_t idx, uint32_t workers) noexcept :
+			ring(ring_capacity),
+			routed_event(),
+			builder(listener, depth, idx, workers),
+			thread(),
+			routed(0),
+			barriers(0) {}
+	};
+
+	std::vector<std::unique_ptr<Worker>> _workers;
+	const bool _barrier_on_eot;
+	Message _message;       // the packet level fields of the next message
+	Worker* _snapshot;      // the worker the current snapshot is routed to
+	uint64_t _barriers;
+	concurrent::Parker _barrier_event; // a worker has passed a barrier
+	bool _running;
+
+public:
+
+	ShardedBookBuilder(const ShardedBookBuilder&) = delete;
+	ShardedBookBuilder& operator=(const ShardedBookBuilder&) = delete;
+
+	/**
+	 * Start the workers.
+	 * @param listeners - an array of @workers listeners, worker 'i' notifies 'listeners[i]'.
+	 * @param workers - the number of worker threads.
+	 * @param depth - the number of levels per side in the depth views.
+	 * @param ring_capacity - the number of messages a ring holds.
+	 * @param barrier_on_eot - set a barrier after every message with the 'EndOfTransaction' flag.
+	 */
+	ShardedBookBuilder(Listener* listeners, size_t workers, size_t depth, size_t ring_capacity,
+	                   bool barrier_on_eot) noexcept :
+		_workers(),
+		_barrier_on_eot(barrier_on_eot),
+		_message(),
+		_snapshot(nullptr),
+		_barriers(0),
+		_barrier_event(),
+		_running(true) {
+		for(size_t idx = 0; idx < workers; ++idx) {
+			_workers.emplace_back(new Worker(ring_capacity, listeners[idx], depth, uint32_t(idx), uint32_t(workers)));
+		}
+		for(auto& worker : _workers) {
+			Worker* w = worker.get();
+			w->thread = std::thread([this, w]() {
+				work(*w, _barrier_event);
+			});
+		}
+	}
+
+	~ShardedBookBuilder() noexcept {
+		stop();
+	}
+
+	inline size_t workers() const noexcept {
+		return _workers.size();
+	}
+
+	/**
+	 * @return The book builder of the worker 'idx'. MUST NOT be used before stop() or outside of barrier().
+	 */
+	inline BookBuilder<Listener>& builder(size_t idx) noexcept {
+		return _workers[idx]->builder;
+	}
+
+	/**
+	 * Wait until all the workers have applied all the messages routed before the call.
+	 */
+	void barrier() noexcept {
+		Message msg;
+		msg.kind = Message::Kind::Barrier;
+		const uint64_t barrier = ++_barriers;
+		for(auto& worker : _workers) {
+			send(*worker, msg);
+		}
+		for(auto& worker : _workers) {
+			const Worker* w = worker.get();
+			_barrier_event.await([w, barrier]() {
+				return w->barriers.load(std::memory_order_acquire) == barrier;
+			});
+		}
+	}
+
+	/**
+	 * Apply all the routed messages and stop the workers.
+	 */
+	void stop() noexcept {
+		if(_running) {
+			Message msg;
+			msg.kind = Message::Kind::Stop;
+			for(auto& worker : _workers) {
+				send(*worker, msg);
+			}
+			for(auto& worker : _workers) {
+				worker->thread.join();
+			}
+			_running = false;
+		}
+	}
+
+	/**
+	 * MUST be called after stop().
+	 */
+	void dump_stats(FILE* out) const noexcept {
+		for(size_t idx = 0; idx < _workers.size(); ++idx) {
+			fprintf(out, "Worker [idx=%zu routed=%lu] | ", idx, _workers[idx]->routed);
+			_workers[idx]->builder.dump_stats(out);
+		}
+		fprintf(out, "ShardedBookBuilder [ workers=%zu barriers=%lu ]\n", _workers.size(), _barriers);
+	}
+
+	// simba::Handler
+
+	inline void on_packet_header(const simba::MarketDataPacketHeader& header) noexcept {
+		_message.packet_flags = header.msg_flags;
+		_message.sending_time = header.sending_time;
+	}
+
+	inline void on_order_update(const simba::OrderUpdate& msg) noexcept {
+		_message.kind = Message::Kind::OrderUpdate;
+		_message.update = msg;
+		route(worker_of(msg.security_id));
+		transaction_end(msg.md_flags);
+	}
+
+	inline void on_order_execution(const simba::OrderExecution& msg) noexcept {
+		_message.kind = Message::Kind::OrderExecution;
+		_message.execution = msg;
+		route(worker_of(msg.security_id));
+		transaction_end(msg.md_flags);
+	}
+
+	inline void on_snapshot_root(const simba::OrderBookSnapshotRoot& msg) noexcept {
+		_snapshot = &worker_of(int32_t(msg.security_id));
+		_message.kind = Message::Kind::SnapshotRoot;
+		_message.root = msg;
+		route(*_snapshot);
+	}
+
+	inline void on_group_size(const simba::GroupSize& group) noexcept {
+		_message.kind = Message::Kind::GroupSize;
+		_message.group = group;
+		route(*_snapshot);
+	}
+
+	inline void on_snapshot_entry(const simba::OrderBookSnapshotEntry& entry) noexcept {
+		_message.kind = Message::Kind::SnapshotEntry;
+		_message.entry = entry;
+		route(*_snapshot);
+	}
+
+	/**
+	 * EmptyBook and TradingSessionStatus are routed to all the workers.
+	 */
+	inline void on_empty_book(const simba::EmptyBook& msg) noexcept {
+		_message.kind = Message::Kind::EmptyBook;
+		_message.empty_book = msg;
+		for(auto& worker : _workers) {
+			route(*worker);
+		}
+	}
+
+	inline void on_security_status(const simba::SecurityStatus& msg) noexcept {
+		_message.kind = Message::Kind::SecurityStatus;
+		_message.status.security_id = msg.security_id;
+		_message.status.security_trading_status = msg.security_trading_status;
+		route(worker_of(msg.security_id));
+	}
+
+	inline void on_trading_session_status(const simba::TradingSessionStatus& msg) noexcept {
+		_message.kind = Message::Kind::TradingSessionStatus;
+		_message.session = msg;
+		for(auto& worker : _workers) {
+			route(*worker);
+		}
+	}
+
+protected:
+
+	inline Worker& worker_of(int32_t security_id) noexcept {
+		const uint32_t hash = (uint32_t(security_id) * 0x9E3779B1u) >> 16u;
+		return *_workers[hash % _workers.size()];
+	}
+
+	inline void route(Worker& worker) noexcept {
+		send(worker, _message);
+		worker.routed++;
+	}
+
+	static inline void send(Worker& worker, const Message& msg) noexcept {
+		worker.ring.push(msg);
+		worker.routed_event.notify();
+	}
+
+	inline void transaction_end(simba::MDFlagsSet flags) noexcept {
+		const simba::MDFlagsSet eot = 1ull << static_cast<uint8_t>(simba::MDFlagsBits::EndOfTransaction);
+		if(_barrier_on_eot && (flags & eot)) {
+			barrier();
+		}
+	}
+
+	static void work(Worker& worker, concurrent::Parker& barrier_event) noexcept {
+		Message msg;
+		simba::MarketDataPacketHeader header{};
+		uint64_t barriers = 0;
+
+		while(true) {
+			if(not worker.ring.try_pop(msg)) {
+				worker.routed_event.await([&worker]() {
+					return not worker.ring.empty();
+				});
+				continue;
+			}
+
+			header.msg_flags = msg.packet_flags;
+			header.sending_time = msg.sending_time;
+
+			switch(msg.kind) {
+				case Message::Kind::OrderUpdate:
+					worker.builder.on_packet_header(header);
+					worker.builder.on_order_update(msg.update);
+					break;
+
+				case Message::Kind::OrderExecution:
+					worker.builder.on_packet_header(header);
+					worker.builder.on_order_execution(msg.execution);
+					break;
+
+				case Message::Kind::SnapshotRoot:
+					worker.builder.on_packet_header(header);
+					worker.builder.on_snapshot_root(msg.root);
+					break;
+
+				case Message::Kind::GroupSize:
+					worker.builder.on_group_size(msg.group);
+					break;
+
+				case Message::Kind::SnapshotEntry:
+					worker.builder.on_snapshot_entry(msg.entry);
+					break;
+
+				case Message::Kind::EmptyBook:
+					worker.builder.on_packet_header(header);
+					worker.builder.on_empty_book(msg.empty_book);
+					break;
+
+				case Message::Kind::SecurityStatus: {
+					simba::SecurityStatus status{};
+					status.security_id = msg.status.security_id;
+					status.security_trading_status = msg.status.security_trading_status;
+					worker.builder.on_security_status(status);
+					break;
+				}
+
+				case Message::Kind::TradingSessionStatus:
+					worker.builder.on_trading_session_status(msg.session);
+					break;
+
+				case Message::Kind::Barrier:
+					worker.barriers.store(++barriers, std::memory_order_release);
+					barrier_event.notify();
+					break;
+
+				case Message::Kind::Stop:
+					return;
+			}
+		}
+	}
+
+};
+
+}; // namespace book
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace book {
+
+/**
+ * SlabPool allocates the nodes of a type from slabs of SLAB_SIZE nodes and addresses them by 32-bit handles:
+ *
+ *   handle = slab << SLAB_BITS | index
+ *
+ * The released nodes are linked into a free list through 'Node::next' and reused first,
+ * the slabs are never returned to malloc. The nodes don't move, the references stay valid.
+ **/
+template <typename Node>
+class SlabPool {
+public:
+
+	using Handle = uint32_t;
+
+	static constexpr Handle NONE = UINT32_MAX;
+	static constexpr uint32_t SLAB_BITS = 12u;
+	static constexpr uint32_t SLAB_SIZE = 1u << SLAB_BITS;
+
+protected:
+
+	std::vector<std::unique_ptr<Node[]>> _slabs;
+	Handle _free;    // the head of the free list
+	uint32_t _used;  // the nodes of the last slab ever allocated
+	size_t _live;
+
+public:
+
+	SlabPool(const SlabPool&) = delete;
+	SlabPool& operator=(const SlabPool&) = delete;
+
+	SlabPool() noexcept :
+		_slabs(),
+		_free(NONE),
+		_used(SLAB_SIZE),
+		_live(0) {}
+
+	inline Node& operator[](Handle handle) noexcept {
+		return _slabs[handle >> SLAB_BITS][handle & (SLAB_SIZE - 1u)];
+	}
+
+	inline const Node& operator[](Handle handle) const noexcept {
+		return _slabs[handle >> SLAB_BITS][handle & (SLAB_SIZE - 1u)];
+	}
+
+	/**
+	 * @return The handle of a node, the node is not initialized.
+	 */
+	inline Handle allocate() noexcept {
+		_live++;
+		if(_free != NONE) {
+			const Handle handle = _free;
+			_free = (*this)[handle].next;
+			return handle;
+		}
+		if(_used == SLAB_SIZE) {
+			_slabs.emplace_back(new Node[SLAB_SIZE]);
+			_used = 0;
+		}
+		return Handle(_slabs.size() - 1u) << SLAB_BITS | _used++;
+	}
+
+	inline void release(Handle handle) noexcept {
+		(*this)[handle].next = _free;
+		_free = handle;
+		_live--;
+	}
+
+	inline size_t live() const noexcept {
+		return _live;
+	}
+
+	inline size_t bytes() const noexcept {
+		return _slabs.size() * SLAB_SIZE * sizeof(Node);
+	}
+
+};
+
+}; // namespace book
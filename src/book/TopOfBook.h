@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "BookBuilder.h"
+
+namespace book {
+
+/**
+ * TopOfBook is a flat copy of the top levels of a book.
+ * It is trivially copyable, so it might be published through concurrent::SeqLock or shared memory.
+ **/
+struct TopOfBook {
+
+	static constexpr uint32_t LEVELS = 5u;
+
+	int32_t security_id;
+	uint32_t rpt_seq;
+	uint64_t update_time; // 'sending_time' of the last applied packet
+	uint32_t bid_levels;
+	uint32_t ask_levels;
+	Level bids[LEVELS];
+	Level asks[LEVELS];
+
+	void assign(const Security& sec) noexcept {
+		security_id = sec.id;
+		rpt_seq = sec.rpt_seq;
+		update_time = sec.update_time;
+		bid_levels = copy_side(sec.depth, Side::Bid, bids);
+		ask_levels = copy_side(sec.depth, Side::Ask, asks);
+	}
+
+	/**
+	 * Assign the emptied book of @sec, its depth view is not read.
+	 */
+	void clear(const Security& sec) noexcept {
+		security_id = sec.id;
+		rpt_seq = sec.rpt_seq;
+		update_time = sec.update_time;
+		bid_levels = 0;
+		ask_levels = 0;
+	}
+
+	/**
+	 * @return true - if @changes affect the levels kept by TopOfBook.
+	 */
+	static inline bool affected(const DepthView::Changes& changes) noexcept {
+		const uint32_t top = (1u << LEVELS) - 1u;
+		return ((changes.bids | changes.asks) & top) != 0;
+	}
+
+	void dump(FILE* out) const noexcept {
+		fprintf(out, "TopOfBook [");
+		fprintf(out, " security_id=%d", security_id);
+		fprintf(out, " rpt_seq=%u", rpt_seq);
+		fprintf(out, " update_time=%lu", update_time);
+		for(uint32_t i = 0; i < bid_levels; ++i) {
+			fprintf(out, " bid[%u]=%f:%ld:%u", i, double(bids[i].price) / 100000, bids[i].size, bids[i].count);
+		}
+		for(uint32_t i = 0; i < ask_levels; ++i) {
+			fprintf(out, " ask[%u]=%f:%ld:%u", i, double(asks[i].price) / 100000, asks[i].size, asks[i].count);
+		}
+		fprintf(out, " ]\n");
+	}
+
+protected:
+
+	static inline uint32_t copy_side(const DepthView& depth, Side side, Level* levels) noexcept {
+		const size_t limit = depth.depth() < LEVELS ? depth.depth() : LEVELS;
+		uint32_t count = 0;
+		for(size_t i = 0; i < limit; ++i) {
+			const Level& level = depth.level(side, i);
+			if(level.count == 0) {
+				break;
+			}
+			levels[count++] = level;
+		}
+		return count;
+	}
+
+};
+
+}; // namespace book
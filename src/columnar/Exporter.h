@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+
+#include "TableWriter.h"
+#include "../simba/Handler.h"
+#include "../simba/Schema.h"
+
+namespace columnar {
+
+/**
+ * Exporter is a simba::Handler which writes every decoded message into the table file of its simba::Table:
+ * '<dir>/OrderUpdate.col', '<dir>/OrderExecution.col' and '<dir>/OrderBookSnapshot.col'.
+ **/
+class Exporter : public simba::Handler {
+protected:
+	TableWriter _tables[size_t(simba::Table::COUNT)];
+	simba::RowContext _context;
+
+public:
+
+	Exporter() noexcept :
+		_tables(),
+		_context() {}
+
+	/**
+	 * Create the directory if necessary and the table files.
+	 * @param rows_per_chunk - the number of rows per chunk.
+	 * @param dictionary - encode 'security_id' with the dictionary.
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* dir, uint32_t rows_per_chunk, bool dictionary) noexcept {
+		if(mkdir(dir, 0755) != 0 && errno != EEXIST) {
+			fprintf(stderr, "'%s' : mkdir() failed: %s\n", dir, strerror(errno));
+			return false;
+		}
+
+		for(uint8_t idx = 0; idx < uint8_t(simba::Table::COUNT); ++idx) {
+			const simba::TableSchema& schema = simba::table_schema(static_cast<simba::Table>(idx));
+			const std::string path = std::string(dir) + "/" + schema.name + ".col";
+			if(not _tables[idx].open(path.c_str(), schema, rows_per_chunk, dictionary)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Complete the files.
+	 * @return false - in case of any errors.
+	 */
+	bool close() noexcept {
+		bool result = true;
+		for(TableWriter& table : _tables) {
+			result = table.close() && result;
+		}
+		return result;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "Exporter [");
+		for(uint8_t idx = 0; idx < uint8_t(simba::Table::COUNT); ++idx) {
+			fprintf(out, " %s=%lu", simba::table_schema(static_cast<simba::Table>(idx)).name, _tables[idx].rows());
+		}
+		fprintf(out, " ]\n");
+	}
+
+	// simba::Handler
+
+	inline void on_packet_header(const simba::MarketDataPacketHeader& header) noexcept {
+		_context.sending_time = header.sending_time;
+		_context.msg_seq_num = header.msg_seq_num;
+	}
+
+	inline void on_order_update(const simba::OrderUpdate& msg) noexcept {
+		table(simba::Table::OrderUpdate).append(&msg, &_context);
+	}
+
+	inline void on_order_execution(const simba::OrderExecution& msg) noexcept {
+		table(simba::Table::OrderExecution).append(&msg, &_context);
+	}
+
+	inline void on_snapshot_root(const simba::OrderBookSnapshotRoot& msg) noexcept {
+		_context.security_id = int32_t(msg.security_id);
+		_context.rpt_seq = msg.rpt_seq;
+	}
+
+	inline void on_snapshot_entry(const simba::OrderBookSnapshotEntry& entry) noexcept {
+		table(simba::Table::OrderBookSnapshot).append(&entry, &_context);
+	}
+
+protected:
+
+	inline TableWriter& table(simba::Table table) noexcept {
+		return _tables[static_cast<uint8_t>(table)];
+	}
+
+};
+
+}; // namespace columnar
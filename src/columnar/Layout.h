@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+namespace columnar {
+
+/**
+ * A table file holds the rows of a single template stored column by column:
+ *
+ *   | FileHeader | ColumnDesc[columns] | chunk 0: column 0 | column 1 | ... | chunk 1: column 0 | ... |
+ *   | ColumnChunk[chunks][columns] | int32_t dictionary[dictionary_size] |
+ *
+ * A chunk holds up to 'rows_per_chunk' rows, a column of a chunk is a plain array of 'width' byte values
+ * aligned to CHUNK_ALIGNMENT, so a mapped file is used as is. The directory (ColumnChunk) keeps the offset,
+ * the number of rows and min/max of every column of every chunk, the queries might skip the chunks by the stats.
+ *
+ * The values are in the host byte order, a file written on a host with other byte order is rejected
+ * by the magic. The nullable values are stored as is, ColumnDesc::null_value is the null of the column,
+ * the nulls are not counted by the stats.
+ *
+ * A dictionary encoded column (COLUMN_DICTIONARY) stores the codes [0, dictionary_size),
+ * 'dictionary[code]' is the original value.
+ **/
+
+static constexpr uint64_t COL_MAGIC = 0x4C4F432D41424D53ull; // "SMBA-COL"
+static constexpr uint32_t COL_VERSION = 1u;
+static constexpr uint64_t CHUNK_ALIGNMENT = 64u;
+
+enum class Kind : uint8_t {
+	Int,  // signed integer, a decimal if 'scale' is not zero
+	UInt, // unsigned integer
+	Char
+};
+
+inline const char* kind_name(Kind kind) noexcept {
+	switch(kind) {
+		case Kind::Int: return "Int";
+		case Kind::UInt: return "UInt";
+		case Kind::Char: return "Char";
+		default:
+			return "UNKNOWN";
+	}
+}
+
+enum ColumnFlags : uint8_t {
+	COLUMN_NULLABLE = 1u,
+	COLUMN_DICTIONARY = 2u
+};
+
+struct FileHeader {
+	uint64_t magic;
+	uint32_t version;
+	uint16_t template_id;
+	uint16_t columns;
+	uint32_t rows_per_chunk;
+	uint32_t chunks;
+	uint64_t rows;
+	uint64_t directory_offset;  // ColumnChunk[chunks][columns]
+	uint64_t dictionary_offset; // int32_t[dictionary_size]
+	uint32_t dictionary_size;
+	uint32_t reserved[3];
+};
+
+struct ColumnDesc {
+	char name[32];
+	Kind kind;
+	uint8_t width;  // bytes per value: 1, 2, 4 or 8
+	uint8_t scale;  // the number of the fraction digits of a decimal
+	uint8_t flags;  // ColumnFlags
+	uint32_t reserved;
+	int64_t null_value;
+};
+
+struct ColumnChunk {
+	uint64_t offset;
+	uint32_t rows;
+	uint32_t reserved;
+	int64_t min;    // UInt columns keep the bits of uint64_t
+	int64_t max;    // min > max - the chunk has no values except nulls
+};
+
+static_assert(sizeof(FileHeader) == 64u, "FileHeader layout");
+static_assert(sizeof(ColumnDesc) == 48u, "ColumnDesc layout");
+static_assert(sizeof(ColumnChunk) == 32u, "ColumnChunk layout");
+
+static inline constexpr uint64_t align_chunk(uint64_t offset) noexcept {
+	return (offset + CHUNK_ALIGNMENT - 1u) & ~(CHUNK_ALIGNMENT - 1u);
+}
+
+}; // namespace columnar
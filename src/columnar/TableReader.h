@@ -0,0 +1,240 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "Layout.h"
+#include "../output/Format.h"
+
+namespace columnar {
+
+/**
+ * TableReader maps a table file (see Layout.h) for reading, the columns are accessed in place.
+ *
+ *   const int64_t* px = reader.values<int64_t>(chunk, reader.column("md_entry_px"));
+ **/
+class TableReader {
+protected:
+	const char* _data;
+	size_t _size;
+	const FileHeader* _header;
+	const ColumnDesc* _columns;
+	const ColumnChunk* _directory;
+	const int32_t* _dictionary;
+
+public:
+
+	static constexpr uint16_t NONE = UINT16_MAX;
+
+	TableReader(const TableReader&) = delete;
+	TableReader& operator=(const TableReader&) = delete;
+
+	TableReader() noexcept :
+		_data(nullptr),
+		_size(0),
+		_header(nullptr),
+		_columns(nullptr),
+		_directory(nullptr),
+		_dictionary(nullptr) {}
+
+	~TableReader() noexcept {
+		close();
+	}
+
+	/**
+	 * Map the file and validate the layout.
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* path) noexcept {
+		close();
+		const int fd = ::open(path, O_RDONLY);
+		if(fd < 0) {
+			fprintf(stderr, "'%s' : open() failed: %s\n", path, strerror(errno));
+			return false;
+		}
+
+		const off_t size = lseek(fd, 0, SEEK_END);
+		if(size < off_t(sizeof(FileHeader))) {
+			fprintf(stderr, "'%s' : not a table file\n", path);
+			::close(fd);
+			return false;
+		}
+
+		void* addr = mmap(nullptr, size_t(size), PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if(addr == MAP_FAILED) {
+			fprintf(stderr, "mmap() failed: %s\n", strerror(errno));
+			return false;
+		}
+		_data = static_cast<const char*>(addr);
+		_size = size_t(size);
+
+		if(not validate()) {
+			fprintf(stderr, "'%s' : the table file is corrupted or incomplete\n", path);
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void close() noexcept {
+		if(_data) {
+			munmap(const_cast<char*>(_data), _size);
+			_data = nullptr;
+			_size = 0;
+		}
+	}
+
+	inline const FileHeader& header() const noexcept {
+		return *_header;
+	}
+
+	inline uint16_t columns() const noexcept {
+		return _header->columns;
+	}
+
+	inline uint32_t chunks() const noexcept {
+		return _header->chunks;
+	}
+
+	inline const ColumnDesc& desc(uint16_t column) const noexcept {
+		return _columns[column];
+	}
+
+	/**
+	 * @return The index of the column @name or NONE.
+	 */
+	uint16_t column(const char* name) const noexcept {
+		for(uint16_t idx = 0; idx < _header->columns; ++idx) {
+			if(strncmp(_columns[idx].name, name, sizeof(_columns[idx].name)) == 0) {
+				return idx;
+			}
+		}
+		return NONE;
+	}
+
+	inline const ColumnChunk& chunk(uint32_t chunk, uint16_t column) const noexcept {
+		return _directory[size_t(chunk) * _header->columns + column];
+	}
+
+	/**
+	 * @return The values of @column in @chunk, 'chunk(chunk, column).rows' values.
+	 *   T MUST have the column width.
+	 */
+	template <typename T>
+	inline const T* values(uint32_t chunk, uint16_t column) const noexcept {
+		return reinterpret_cast<const T*>(_data + this->chunk(chunk, column).offset);
+	}
+
+	/**
+	 * @return The dictionary, 'dictionary()[code]' is the original value of a dictionary encoded column.
+	 */
+	inline const int32_t* dictionary() const noexcept {
+		return _dictionary;
+	}
+
+	inline uint32_t dictionary_size() const noexcept {
+		return _header->dictionary_size;
+	}
+
+	/**
+	 * Print the schema and the chunk stats.
+	 */
+	void dump(FILE* out) const noexcept {
+		fprintf(out, "Table [ template_id=%u rows=%lu chunks=%u rows_per_chunk=%u dictionary_size=%u ]\n",
+		        _header->template_id, _header->rows, _header->chunks, _header->rows_per_chunk,
+		        _header->dictionary_size);
+		for(uint16_t idx = 0; idx < _header->columns; ++idx) {
+			const ColumnDesc& col = _columns[idx];
+			fprintf(out, "Column [ name=%.*s kind=%s width=%u scale=%u%s%s ]\n",
+			        int(sizeof(col.name)), col.name, kind_name(col.kind), col.width, col.scale,
+			        (col.flags & COLUMN_NULLABLE) ? " nullable" : "",
+			        (col.flags & COLUMN_DICTIONARY) ? " dictionary" : "");
+		}
+		for(uint32_t c = 0; c < _header->chunks; ++c) {
+			fprintf(out, "Chunk [ idx=%u rows=%u ] |", c, chunk(c, 0).rows);
+			for(uint16_t idx = 0; idx < _header->columns; ++idx) {
+				char min[output::FORMAT_MAX];
+				char max[output::FORMAT_MAX];
+				const ColumnChunk& cc = chunk(c, idx);
+				const ColumnDesc& col = _columns[idx];
+				*format(min, col, cc.min) = '\0';
+				*format(max, col, cc.max) = '\0';
+				if(empty(col, cc)) {
+					fprintf(out, " %.*s=[]", int(sizeof(col.name)), col.name);
+				} else {
+					fprintf(out, " %.*s=[%s,%s]", int(sizeof(col.name)), col.name, min, max);
+				}
+			}
+			fprintf(out, "\n");
+		}
+	}
+
+protected:
+
+	static inline bool empty(const ColumnDesc& col, const ColumnChunk& cc) noexcept {
+		return col.kind == Kind::Int ? cc.min > cc.max : uint64_t(cc.min) > uint64_t(cc.max);
+	}
+
+	static inline char* format(char* ptr, const ColumnDesc& col, int64_t value) noexcept {
+		switch(col.kind) {
+			case Kind::Int:
+				return col.scale ? output::format_decimal(ptr, value, pow10(col.scale)) : output::format_int(ptr, value);
+			case Kind::Char:
+				*ptr++ = '\'';
+				*ptr++ = char(value);
+				*ptr++ = '\'';
+				return ptr;
+			default:
+				return output::format_uint(ptr, uint64_t(value));
+		}
+	}
+
+	static inline uint64_t pow10(uint8_t scale) noexcept {
+		uint64_t result = 1u;
+		while(scale--) {
+			result *= 10u;
+		}
+		return result;
+	}
+
+	bool validate() noexcept {
+		_header = reinterpret_cast<const FileHeader*>(_data);
+		if(_header->magic != COL_MAGIC || _header->version != COL_VERSION || _header->columns == 0) {
+			return false;
+		}
+
+		_columns = reinterpret_cast<const ColumnDesc*>(_header + 1);
+		const uint64_t directory_size = uint64_t(_header->chunks) * _header->columns * sizeof(ColumnChunk);
+		if(sizeof(FileHeader) + sizeof(ColumnDesc) * _header->columns > _size
+		   || _header->directory_offset + directory_size > _size
+		   || _header->dictionary_offset + uint64_t(_header->dictionary_size) * sizeof(int32_t) > _size) {
+			return false;
+		}
+		_directory = reinterpret_cast<const ColumnChunk*>(_data + _header->directory_offset);
+		_dictionary = reinterpret_cast<const int32_t*>(_data + _header->dictionary_offset);
+
+		for(uint16_t idx = 0; idx < _header->columns; ++idx) {
+			const uint8_t width = _columns[idx].width;
+			if(width != 1u && width != 2u && width != 4u && width != 8u) {
+				return false;
+			}
+			for(uint32_t c = 0; c < _header->chunks; ++c) {
+				const ColumnChunk& cc = chunk(c, idx);
+				if(cc.offset % CHUNK_ALIGNMENT || cc.rows > _header->rows_per_chunk
+				   || cc.offset + uint64_t(cc.rows) * width > _size) {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+};
+
+}; // namespace columnar
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Layout.h"
+#include "../book/SecurityMap.h"
+#include "../simba/Schema.h"
+
+namespace columnar {
+
+/**
+ * TableWriter appends the rows of a simba::TableSchema to a table file (see Layout.h).
+ * The rows are accumulated column by column in the chunk buffer, a full chunk is written
+ * with a single sequential write. The directory and the dictionary are written by close().
+ * A failed write stops the table: the later rows are dropped and close() doesn't complete the file.
+ **/
+class TableWriter {
+protected:
+
+	struct Column {
+		const simba::Field* field;
+		Kind kind;
+		bool dictionary;
+		size_t base;     // the column values offset in the chunk buffer
+		ColumnChunk chunk;
+	};
+
+	std::vector<Column> _columns;
+	std::vector<ColumnChunk> _directory;
+	std::unique_ptr<char[]> _buffer;      // a chunk being written, the columns follow each other
+	size_t _buffer_size;
+	FileHeader _header;
+	book::SecurityMap _codes;
+	std::vector<int32_t> _dictionary;
+	uint64_t _offset;
+	uint32_t _rows;                       // rows in the current chunk
+	int _fd;
+	bool _failed;                         // a write has failed, the file is not completed
+
+public:
+
+	TableWriter(const TableWriter&) = delete;
+	TableWriter& operator=(const TableWriter&) = delete;
+
+	TableWriter() noexcept :
+		_columns(),
+		_directory(),
+		_buffer(),
+		_buffer_size(0),
+		_header(),
+		_codes(),
+		_dictionary(),
+		_offset(0),
+		_rows(0),
+		_fd(-1),
+		_failed(false) {}
+
+	~TableWriter() noexcept {
+		close();
+	}
+
+	/**
+	 * Create the file and write the schema.
+	 * @param rows_per_chunk - the number of rows per chunk.
+	 * @param dictionary - encode the simba::FIELD_KEY fields with the dictionary.
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* path, const simba::TableSchema& schema, uint32_t rows_per_chunk, bool dictionary) noexcept {
+		const uint16_t count = schema.count;
+		close();
+		_fd = ::open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+		if(_fd < 0) {
+			fprintf(stderr, "'%s' : open() failed: %s\n", path, strerror(errno));
+			return false;
+		}
+
+		_header = FileHeader();
+		_header.magic = COL_MAGIC;
+		_header.version = COL_VERSION;
+		_header.template_id = static_cast<uint16_t>(schema.template_id);
+		_header.columns = count;
+		_header.rows_per_chunk = rows_per_chunk;
+
+		_columns.clear();
+		_directory.clear();
+		_dictionary.clear();
+		_buffer_size = 0;
+		std::unique_ptr<ColumnDesc[]> descs(new ColumnDesc[count]());
+		for(uint16_t idx = 0; idx < count; ++idx) {
+			const simba::Field& field = schema.fields[idx];
+			const bool encoded = dictionary && (field.flags & simba::FIELD_KEY) && field.width == sizeof(int32_t);
+			Column column{&field, encoded ? Kind::UInt : kind_of(field.kind), encoded, _buffer_size, {}};
+			reset_stats(column);
+
+			ColumnDesc& desc = descs[idx];
+			strncpy(desc.name, field.name, sizeof(desc.name) - 1u);
+			desc.kind = column.kind;
+			desc.width = field.width;
+			desc.scale = field.scale;
+			desc.flags = uint8_t(((field.flags & simba::FIELD_NULLABLE) ? COLUMN_NULLABLE : 0u)
+			                     | (encoded ? COLUMN_DICTIONARY : 0u));
+			desc.null_value = field.null_value;
+
+			_buffer_size += align_chunk(size_t(rows_per_chunk) * field.width);
+			_columns.push_back(std::move(column));
+		}
+		_buffer.reset(new char[_buffer_size]());
+		_rows = 0;
+
+		_offset = 0;
+		_failed = false;
+		return write(&_header, sizeof(_header)) && write(descs.get(), sizeof(ColumnDesc) * count) && pad();
+	}
+
+	/**
+	 * Append a row.
+	 * @param message - the message record.
+	 * @param context - the context record.
+	 */
+	inline void append(const void* message, const void* context) noexcept {
+		if(_failed) {
+			return;
+		}
+		for(Column& column : _columns) {
+			const simba::Field& field = *column.field;
+			char* dst = _buffer.get() + column.base + size_t(_rows) * field.width;
+			const int64_t value = field.load(message, context);
+
+			if(column.dictionary) {
+				const uint32_t code = _codes.insert(int32_t(value));
+				if(code == _dictionary.size()) {
+					_dictionary.push_back(int32_t(value));
+				}
+				memcpy(dst, &code, sizeof(code));
+				update_stats(column, code);
+				continue;
+			}
+
+			memcpy(dst, field.address(message, context), field.width);
+			if(not field.is_null(value)) {
+				update_stats(column, value);
+			}
+		}
+
+		if(++_rows == _header.rows_per_chunk) {
+			flush_chunk();
+		}
+	}
+
+	inline uint64_t rows() const noexcept {
+		return _header.rows + _rows;
+	}
+
+	/**
+	 * Write the last chunk, the directory, the dictionary and the final header.
+	 * @return false - in case of any errors.
+	 */
+	bool close() noexcept {
+		if(_fd < 0) {
+			return true;
+		}
+
+		bool result = not _failed && flush_chunk();
+
+		_header.chunks = uint32_t(_directory.size() / _columns.size());
+		_header.directory_offset = _offset;
+		result = result && write(_directory.data(), sizeof(ColumnChunk) * _directory.size());
+
+		_header.dictionary_offset = _offset;
+		_header.dictionary_size = uint32_t(_dictionary.size());
+		result = result && write(_dictionary.data(), sizeof(int32_t) * _dictionary.size());
+
+		if(result && pwrite(_fd, &_header, sizeof(_header), 0) != ssize_t(sizeof(_header))) {
+			fprintf(stderr, "pwrite() failed: %s\n", strerror(errno));
+			result = false;
+		}
+
+		::close(_fd);
+		_fd = -1;
+		return result;
+	}
+
+protected:
+
+	static inline Kind kind_of(simba::FieldKind kind) noexcept {
+		switch(kind) {
+			case simba::FieldKind::Int: return Kind::Int;
+			case simba::FieldKind::Char: return Kind::Char;
+			default:
+				return Kind::UInt;
+		}
+	}
+
+	static inline void reset_stats(Column& column) noexcept {
+		if(column.kind == Kind::Int) {
+			column.chunk.min = INT64_MAX;
+			column.chunk.max = INT64_MIN;
+		} else {
+			column.chunk.min = int64_t(UINT64_MAX);
+			column.chunk.max = 0;
+		}
+	}
+
+	static inline void update_stats(Column& column, int64_t value) noexcept {
+		ColumnChunk& chunk = column.chunk;
+		if(column.kind == Kind::Int) {
+			chunk.min = value < chunk.min ? value : chunk.min;
+			chunk.max = value > chunk.max ? value : chunk.max;
+		} else {
+			chunk.min = uint64_t(value) < uint64_t(chunk.min) ? value : chunk.min;
+			chunk.max = uint64_t(value) > uint64_t(chunk.max) ? value : chunk.max;
+		}
+	}
+
+	bool flush_chunk() noexcept {
+		if(_rows == 0) {
+			return true;
+		}
+
+		// The columns of a partial chunk are moved to close the gaps.
+		size_t size = 0;
+		for(Column& column : _columns) {
+			const size_t length = size_t(_rows) * column.field->width;
+			if(size != column.base) {
+				memmove(_buffer.get() + size, _buffer.get() + column.base, length);
+			}
+			memset(_buffer.get() + size + length, 0, align_chunk(length) - length);
+
+			column.chunk.offset = _offset + size;
+			column.chunk.rows = _rows;
+			_directory.push_back(column.chunk);
+			reset_stats(column);
+
+			size += align_chunk(length);
+		}
+
+		_header.rows += _rows;
+		_rows = 0;
+		return write(_buffer.get(), size);
+	}
+
+	bool write(const void* data, size_t size) noexcept {
+		const char* ptr = static_cast<const char*>(data);
+		while(size > 0) {
+			const ssize_t written = ::write(_fd, ptr, size);
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				fprintf(stderr, "write() failed: %s\n", strerror(errno));
+				_failed = true;
+				return false;
+			}
+			ptr += written;
+			size -= size_t(written);
+			_offset += uint64_t(written);
+		}
+		return true;
+	}
+
+	inline bool pad() noexcept {
+		static const char zeros[CHUNK_ALIGNMENT] = {};
+		return write(zeros, align_chunk(_offset) - _offset);
+	}
+
+};
+
+}; // namespace columnar
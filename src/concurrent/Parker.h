@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "cpu.h"
+
+namespace concurrent {
+
+/**
+ * Parker puts a single thread waiting for a condition to sleep on a futex, so an idle thread doesn't take a core:
+ *
+ *   waiter: await(condition)                  notifier: make the condition true, notify()
+ *
+ * The waiter spins for the Backoff budget and yields a few times first, then raises 'parked', checks
+ * the condition once more and sleeps while 'parked' is raised. The notifier pays a fence and a load while the waiter is awake,
+ * the first notify() after the waiter has parked clears the flag and makes the only wake call.
+ * The fences pair the waiter's flag with the notifier's condition store, so a wakeup is never missed.
+ **/
+class Parker {
+
+	static constexpr uint32_t YIELD_LIMIT = 64u; // the yields after the spins, the producer might share the core
+
+	std::atomic<uint32_t> _parked;
+
+public:
+
+	Parker(const Parker&) = delete;
+	Parker& operator=(const Parker&) = delete;
+
+	Parker() noexcept : _parked(0) {}
+
+	/**
+	 * Wait until @condition() returns true, the waiter is a single thread.
+	 */
+	template <typename Condition>
+	inline void await(Condition condition) noexcept {
+		Backoff backoff;
+		uint32_t yields = 0;
+		while(not condition()) {
+			if(backoff.spinning() || yields++ < YIELD_LIMIT) {
+				backoff.pause();
+				continue;
+			}
+			_parked.store(1u, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(condition()) {
+				_parked.store(0, std::memory_order_relaxed);
+				return;
+			}
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_parked), FUTEX_WAIT_PRIVATE, 1u, nullptr, nullptr, 0);
+		}
+		_parked.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * Wake the waiter, the condition MUST have been made true before the call.
+	 */
+	inline void notify() noexcept {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(_parked.load(std::memory_order_relaxed) && _parked.exchange(0, std::memory_order_relaxed)) {
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&_parked), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+		}
+	}
+
+};
+
+}; // namespace concurrent
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "cpu.h"
+
+namespace concurrent {
+
+/**
+ * SeqLock protects a trivially copyable value with a single writer and any number of readers.
+ * Readers never block the writer and never write to the shared memory, so the value
+ * might be placed into a memory region shared between processes.
+ *
+ * The sequence is odd while the writer is updating the value.
+ * A reader retries if the sequence is odd or has changed while the value was being copied.
+ **/
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) SeqLock {
+	static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "SeqLock requires lock free atomics");
+
+	std::atomic<uint32_t> seq;
+	T value;
+
+	/**
+	 * Writer side. MUST NOT be called concurrently.
+	 * @param fn - a callable 'void(T&)' which updates the value in place.
+	 */
+	template <typename Fn>
+	inline void update(Fn&& fn) noexcept {
+		const uint32_t s = seq.load(std::memory_order_relaxed);
+		seq.store(s + 1u, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		fn(value);
+		seq.store(s + 2u, std::memory_order_release);
+	}
+
+	/**
+	 * Reader side, makes a single attempt.
+	 * @param out - a variable to copy the value to.
+	 * @return false - if the value was being updated, 'out' is inconsistent.
+	 */
+	inline bool try_read(T& out) const noexcept {
+		const uint32_t s1 = seq.load(std::memory_order_acquire);
+		if(s1 & 1u) {
+			return false;
+		}
+		memcpy(&out, const_cast<const T*>(&value), sizeof(T));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return seq.load(std::memory_order_relaxed) == s1;
+	}
+
+	/**
+	 * Reader side, spins until a consistent copy is made.
+	 * @param out - a variable to copy the value to.
+	 * @return The sequence of the copy, it changes every time the value is updated.
+	 */
+	inline uint32_t read(T& out) const noexcept {
+		while(true) {
+			const uint32_t s1 = seq.load(std::memory_order_acquire);
+			if((s1 & 1u) == 0) {
+				memcpy(&out, const_cast<const T*>(&value), sizeof(T));
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if(seq.load(std::memory_order_relaxed) == s1) {
+					return s1;
+				}
+			}
+			cpu_relax();
+		}
+	}
+
+	/**
+	 * @return The current sequence, readers might poll it to detect updates without copying.
+	 */
+	inline uint32_t version() const noexcept {
+		return seq.load(std::memory_order_acquire);
+	}
+
+};
+
+}; // namespace concurrent
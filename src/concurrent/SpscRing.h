@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "cpu.h"
+
+namespace concurrent {
+
+/**
+ * SpscRing is a bounded lock free single-producer single-consumer queue.
+ *
+ * The producer owns 'tail' and the consumer owns 'head', each side keeps a cached copy
+ * of the other side's index and reloads it only when the ring looks full (or empty),
+ * so the cache line of the other side is touched once per many operations.
+ *
+ * The indexes grow monotonically, the slot is 'index & mask'.
+ **/
+template <typename T>
+class SpscRing {
+
+	struct alignas(CACHE_LINE_SIZE) Producer {
+		std::atomic<size_t> tail;
+		size_t head_cache;
+	};
+
+	struct alignas(CACHE_LINE_SIZE) Consumer {
+		std::atomic<size_t> head;
+		size_t tail_cache;
+	};
+
+protected:
+	Producer _producer;
+	Consumer _consumer;
+	std::unique_ptr<T[]> _buffer;
+	const size_t _mask;
+
+public:
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	/**
+	 * @param capacity - the number of elements, rounded up to a power of two.
+	 */
+	explicit SpscRing(size_t capacity) noexcept :
+		_producer(),
+		_consumer(),
+		_buffer(new T[round_up(capacity)]),
+		_mask(round_up(capacity) - 1u) {
+		_producer.tail.store(0, std::memory_order_relaxed);
+		_producer.head_cache = 0;
+		_consumer.head.store(0, std::memory_order_relaxed);
+		_consumer.tail_cache = 0;
+	}
+
+	inline size_t capacity() const noexcept {
+		return _mask + 1u;
+	}
+
+	/**
+	 * Producer side.
+	 * @return false - if the ring is full.
+	 */
+	inline bool try_push(const T& value) noexcept {
+		const size_t tail = _producer.tail.load(std::memory_order_relaxed);
+		if(tail - _producer.head_cache > _mask) {
+			_producer.head_cache = _consumer.head.load(std::memory_order_acquire);
+			if(tail - _producer.head_cache > _mask) {
+				return false;
+			}
+		}
+		_buffer[tail & _mask] = value;
+		_producer.tail.store(tail + 1u, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Producer side, spins while the ring is full.
+	 */
+	inline void push(const T& value) noexcept {
+		Backoff backoff;
+		while(not try_push(value)) {
+			backoff.pause();
+		}
+	}
+
+	/**
+	 * Consumer side.
+	 * @return false - if the ring is empty.
+	 */
+	inline bool try_pop(T& value) noexcept {
+		const size_t head = _consumer.head.load(std::memory_order_relaxed);
+		if(head == _consumer.tail_cache) {
+			_consumer.tail_cache = _producer.tail.load(std::memory_order_acquire);
+			if(head == _consumer.tail_cache) {
+				return false;
+			}
+		}
+		value = _buffer[head & _mask];
+		_consumer.head.store(head + 1u, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * Consumer side.
+	 * @return true - if there is nothing to pop.
+	 */
+	inline bool empty() const noexcept {
+		return _consumer.head.load(std::memory_order_relaxed) == _producer.tail.load(std::memory_order_acquire);
+	}
+
+protected:
+
+	static inline constexpr size_t round_up(size_t value) noexcept {
+		size_t result = 2u;
+		while(result < value) {
+			result <<= 1u;
+		}
+		return result;
+	}
+
+};
+
+}; // namespace concurrent
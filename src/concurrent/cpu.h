@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace concurrent {
+
+static constexpr size_t CACHE_LINE_SIZE = 64u;
+
+/**
+ * A hint for the CPU that the thread is spinning.
+ */
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * Backoff spins for a while and then yields the CPU,
+ * so a waiting thread doesn't starve the thread it waits for if they share a core.
+ */
+class Backoff {
+
+	static constexpr uint32_t SPIN_LIMIT = 1024u;
+
+	uint32_t _spins;
+
+public:
+
+	Backoff() noexcept : _spins(0) {}
+
+	inline void pause() noexcept {
+		if(_spins < SPIN_LIMIT) {
+			++_spins;
+			cpu_relax();
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	inline void reset() noexcept {
+		_spins = 0;
+	}
+
+	/**
+	 * @return false - the spin budget is spent, pause() yields the CPU.
+	 */
+	inline bool spinning() const noexcept {
+		return _spins < SPIN_LIMIT;
+	}
+
+};
+
+}; // namespace concurrent
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "PacketBuilder.h"
+
+namespace gen {
+
+/**
+ * Random is xorshift64*, fast and good enough for the synthetic data.
+ */
+class Random {
+	uint64_t _state;
+
+public:
+
+	explicit Random(uint64_t seed) noexcept : _state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+	inline uint64_t next() noexcept {
+		_state ^= _state >> 12u;
+		_state ^= _state << 25u;
+		_state ^= _state >> 27u;
+		return _state * 0x2545F4914F6CDD1Dull;
+	}
+
+	/**
+	 * @return A value in [0, bound).
+	 */
+	inline uint32_t below(uint32_t bound) noexcept {
+		return uint32_t(((next() >> 32u) * bound) >> 32u);
+	}
+};
+
+struct MarketConfig {
+	uint32_t securities = 16;
+	int32_t first_security_id = 1;
+	uint32_t update_weight = 80;     // the incremental message mix
+	uint32_t execution_weight = 20;
+	uint32_t new_weight = 1;         // the OrderUpdate actions mix
+	uint32_t change_weight = 1;
+	uint32_t delete_weight = 1;
+	uint32_t snapshot_every = 100;   // a snapshot packet per N incremental packets, 0 - no snapshots
+	uint32_t max_messages = 8;       // the messages of an incremental packet are random in [1, max_messages]
+	uint32_t book_orders = 64;       // the live orders per security
+	uint32_t snapshot_entries = 255; // the maximum entries of an OrderBookSnapshot
+	uint32_t status_every = 0;       // a SecurityStatus packet per N incremental packets, 0 - none
+	uint32_t session_every = 0;      // a new trading session per N incremental packets, 0 - a single session
+	uint64_t seed = 1;
+};
+
+/**
+ * MarketGenerator fills the packets of a consistent random order flow: an order is added with New,
+ * then it is changed, executed or deleted, the snapshots contain the live orders of a security.
+ * The prices are around 1000.00 with the 0.01 tick, the securities are picked uniformly.
+ * A new trading session is a packet of EmptyBook and TradingSessionStatus, the books and 'rpt_seq' start over.
+ * A SecurityStatus packet halts a random security or resumes it, the halted one keeps trading.
+ * The memory is allocated by the constructor only.
+ **/
+class MarketGenerator {
+public:
+
+	static constexpr int64_t TICK = 1000;           // 0.01 as simba::Decimal5
+	static constexpr int64_t MID = 100000000;       // 1000.00 as simba::Decimal5
+	static constexpr uint64_t FLAG_DAY = 1ull << static_cast<uint8_t>(simba::MDFlagsBits::Day);
+	static constexpr uint64_t FLAG_EOT = 1ull << static_cast<uint8_t>(simba::MDFlagsBits::EndOfTransaction);
+	static constexpr uint64_t FLAG_ACTIVE = 1ull << static_cast<uint8_t>(simba::MDFlagsBits::ActiveSide);
+
+protected:
+
+	struct Order {
+		int64_t id;
+		int64_t px;
+		int64_t size;
+		simba::MDEntryType side;
+	};
+
+	struct Security {
+		uint32_t count;   // the live orders
+		uint32_t rpt_seq;
+		bool halted;
+	};
+
+	const MarketConfig _config;
+	Random _random;
+	std::vector<Security> _securities;
+	std::vector<Order> _orders;                   // [security][book_orders]
+	std::vector<simba::OrderBookSnapshotEntry> _entries;
+	uint32_t _incremental_seq;
+	uint32_t _snapshot_seq;
+	uint32_t _packets;
+	uint32_t _snapshot_security;
+	uint32_t _incrementals;  // the incremental packets
+	int32_t _trading_session_id;
+	int64_t _next_order_id;
+	int64_t _next_trade_id;
+	uint64_t _messages;
+
+public:
+
+	MarketGenerator(const MarketGenerator&) = delete;
+	MarketGenerator& operator=(const MarketGenerator&) = delete;
+
+	explicit MarketGenerator(const MarketConfig& config) noexcept :
+		_config(sanitize(config)),
+		_random(config.seed),
+		_securities(_config.securities, Security{0, 0, false}),
+		_orders(size_t(_config.securities) * _config.book_orders),
+		_entries(256u),
+		_incremental_seq(1),
+		_snapshot_seq(1),
+		_packets(0),
+		_snapshot_security(0),
+		_incrementals(0),
+		_trading_session_id(0),
+		_next_order_id(1),
+		_next_trade_id(1),
+		_messages(0) {}
+
+	/**
+	 * @return The SBE messages generated.
+	 */
+	inline uint64_t messages() const noexcept {
+		return _messages;
+	}
+
+	/**
+	 * @return The msg_seq_num of the next incremental packet.
+	 */
+	inline uint32_t incremental_seq() const noexcept {
+		return _incremental_seq;
+	}
+
+	/**
+	 * Fill the next packet, @builder is ready to finish().
+	 * @return true - the packet is incremental.
+	 */
+	bool next(PacketBuilder& builder, uint64_t sending_time) noexcept {
+		if(_config.snapshot_every && ++_packets % (_config.snapshot_every + 1u) == 0) {
+			snapshot(builder, sending_time);
+			return false;
+		}
+
+		const uint32_t incremental = _incrementals++;
+		if(_config.session_every && incremental % _config.session_every == 0) {
+			session(builder, sending_time);
+			return true;
+		}
+		if(_config.status_every && incremental % _config.status_every == _config.status_every - 1u) {
+			status(builder, sending_time);
+			return true;
+		}
+
+		builder.begin(_incremental_seq++, sending_time, true);
+		const uint32_t count = 1u + _random.below(_config.max_messages);
+		const uint32_t weights = _config.update_weight + _config.execution_weight;
+		for(uint32_t idx = 0; idx < count; ++idx) {
+			const uint64_t flags = FLAG_DAY | (idx + 1u == count ? FLAG_EOT : 0);
+			const uint32_t sec = _random.below(_config.securities);
+			const bool added = _random.below(weights) < _config.update_weight
+			                   ? update(builder, sec, flags)
+			                   : execution(builder, sec, flags);
+			if(not added) {
+				break;
+			}
+		}
+		return true;
+	}
+
+protected:
+
+	static MarketConfig sanitize(MarketConfig config) noexcept {
+		config.securities = config.securities ? config.securities : 1u;
+		config.max_messages = config.max_messages ? config.max_messages : 1u;
+		config.book_orders = config.book_orders ? config.book_orders : 1u;
+		config.snapshot_entries = config.snapshot_entries < 255u ? config.snapshot_entries : 255u;
+		if(config.update_weight + config.execution_weight == 0) {
+			config.update_weight = 1u;
+		}
+		if(config.new_weight + config.change_weight + config.delete_weight == 0) {
+			config.new_weight = 1u;
+		}
+		return config;
+	}
+
+	inline int32_t security_id(uint32_t sec) const noexcept {
+		return _config.first_security_id + int32_t(sec);
+	}
+
+	inline Order* book(uint32_t sec) noexcept {
+		return &_orders[size_t(sec) * _config.book_orders];
+	}
+
+	bool update(PacketBuilder& builder, uint32_t sec, uint64_t flags) noexcept {
+		Security& security = _securities[sec];
+		Order* orders = book(sec);
+
+		simba::OrderUpdate msg;
+		uint32_t action = 0u;
+		if(security.count) {
+			const uint32_t pick = _random.below(_config.new_weight + _config.change_weight + _config.delete_weight);
+			action = pick < _config.new_weight ? 0u : pick < _config.new_weight + _config.change_weight ? 1u : 2u;
+			if(action == 0u && security.count == _config.book_orders) {
+				action = 2u;
+			}
+		}
+		if(action == 0u) {
+			Order& order = orders[security.count];
+			order.id = _next_order_id++;
+			order.side = _random.below(2u) ? '0' : '1';
+			const int64_t distance = int64_t(1u + _random.below(50u)) * TICK;
+			order.px = order.side == '0' ? MID - distance : MID + distance;
+			order.size = int64_t(1u + _random.below(100u));
+			msg.md_update_action = simba::MDUpdateAction::New;
+			fill(msg, order);
+			if(not builder.add(finish(msg, sec, flags))) {
+				_next_order_id--;
+				return false;
+			}
+			security.count++;
+		} else {
+			const uint32_t idx = _random.below(security.count);
+			Order& order = orders[idx];
+			fill(msg, order);
+			if(action == 1u) {
+				msg.md_entry_size = int64_t(1u + _random.below(100u));
+				msg.md_update_action = simba::MDUpdateAction::Change;
+			} else {
+				msg.md_update_action = simba::MDUpdateAction::Delete;
+			}
+			if(not builder.add(finish(msg, sec, flags))) {
+				return false;
+			}
+			if(action == 1u) {
+				order.size = msg.md_entry_size;
+			} else {
+				order = orders[--security.count];
+			}
+		}
+		security.rpt_seq++;
+		_messages++;
+		return true;
+	}
+
+	bool execution(PacketBuilder& builder, uint32_t sec, uint64_t flags) noexcept {
+		Security& security = _securities[sec];
+		if(security.count == 0) {
+			return update(builder, sec, flags);
+		}
+
+		const uint32_t idx = _random.below(security.count);
+		Order& order = book(sec)[idx];
+		const int64_t qty = int64_t(1u + _random.below(uint32_t(order.size)));
+
+		simba::OrderExecution msg;
+		msg.md_entry_id = order.id;
+		msg.md_entry_px._value = order.px;
+		msg.md_entry_size._value = order.size - qty;
+		msg.last_px._value = order.px;
+		msg.last_qty = qty;
+		msg.trade_id = _next_trade_id;
+		msg.md_flags = flags | FLAG_ACTIVE;
+		msg.security_id = security_id(sec);
+		msg.rpt_seq = security.rpt_seq + 1u;
+		msg.md_update_action = qty == order.size ? simba::MDUpdateAction::Delete : simba::MDUpdateAction::Change;
+		msg.md_entry_type = order.side;
+		if(not builder.add(msg)) {
+			return false;
+		}
+
+		_next_trade_id++;
+		security.rpt_seq++;
+		order.size -= qty;
+		if(order.size == 0) {
+			order = book(sec)[--security.count];
+		}
+		_messages++;
+		return true;
+	}
+
+	/**
+	 * Start a new trading session, the books are emptied.
+	 */
+	void session(PacketBuilder& builder, uint64_t sending_time) noexcept {
+		simba::EmptyBook empty;
+		empty.last_msg_seq_num_processed = _incremental_seq - 1u;
+		builder.begin(_incremental_seq++, sending_time, true);
+		builder.add(empty);
+
+		simba::TradingSessionStatus status;
+		status.trad_ses_open_time = sending_time;
+		status.trad_ses_close_time = sending_time + 86400ull * 1000000000ull;
+		status.trad_ses_interm_clearing_start_time = UINT64_MAX;
+		status.trad_ses_interm_clearing_end_time = UINT64_MAX;
+		status.trading_session_id = ++_trading_session_id;
+		status.exchange_trading_session_id._value = INT32_MIN;
+		status.trad_ses_status = simba::TradSesStatus::Open;
+		status.market_segment_id = 'F';
+		status.trad_ses_event = 0;
+		builder.add(status);
+		_messages += 2u;
+
+		for(Security& security : _securities) {
+			security.count = 0;
+			security.rpt_seq = 0;
+		}
+	}
+
+	/**
+	 * Halt a random security or resume the halted one.
+	 */
+	void status(PacketBuilder& builder, uint64_t sending_time) noexcept {
+		const uint32_t sec = _random.below(_config.securities);
+		Security& security = _securities[sec];
+		security.halted = not security.halted;
+
+		simba::SecurityStatus status;
+		memset(&status, 0, sizeof(status));
+		status.security_id = security_id(sec);
+		snprintf(status.symbol, sizeof(status.symbol), "SEC%d", status.security_id);
+		status.security_trading_status = security.halted ? simba::SecurityTradingStatus::TradingHalt
+		                                                 : simba::SecurityTradingStatus::ReadyToTrade;
+		status.high_limit_px._value = MID * 11 / 10;
+		status.low_limit_px._value = MID * 9 / 10;
+		status.initial_margin_on_buy._value = INT64_MAX;
+		status.initial_margin_on_sell._value = INT64_MAX;
+		status.initial_margin_syntetic._value = INT64_MAX;
+		builder.begin(_incremental_seq++, sending_time, true);
+		builder.add(status);
+		_messages++;
+	}
+
+	void snapshot(PacketBuilder& builder, uint64_t sending_time) noexcept {
+		const uint32_t sec = _snapshot_security++ % _config.securities;
+		const Security& security = _securities[sec];
+		const uint16_t flags = uint16_t(1u << static_cast<uint16_t>(simba::MarketDataPacketHeader::Flags::StartOfSnapshot)
+		                                | 1u << static_cast<uint16_t>(simba::MarketDataPacketHeader::Flags::EndOfSnapshot));
+		builder.begin(_snapshot_seq++, sending_time, false, flags);
+
+		simba::OrderBookSnapshotRoot root;
+		root.security_id = uint32_t(security_id(sec));
+		root.last_msg_seq_sum_processed = _incremental_seq - 1u;
+		root.rpt_seq = security.rpt_seq;
+		root.exchange_trading_session_id = 0;
+
+		size_t count = security.count;
+		const size_t capacity = builder.snapshot_capacity();
+		count = count < _config.snapshot_entries ? count : _config.snapshot_entries;
+		count = count < capacity ? count : capacity;
+		const Order* orders = book(sec);
+		for(size_t idx = 0; idx < count; ++idx) {
+			simba::OrderBookSnapshotEntry& entry = _entries[idx];
+			entry.md_entry_id._value = orders[idx].id;
+			entry.transact_time = sending_time;
+			entry.md_entry_px._value = orders[idx].px;
+			entry.md_entry_size._value = orders[idx].size;
+			entry.trade_id._value = INT64_MIN;
+			entry.md_flags = FLAG_DAY;
+			entry.md_entry_type = orders[idx].side;
+		}
+		if(count == 0) {
+			simba::OrderBookSnapshotEntry& entry = _entries[0];
+			entry.md_entry_id._value = INT64_MIN;
+			entry.transact_time = sending_time;
+			entry.md_entry_px._value = INT64_MAX;
+			entry.md_entry_size._value = INT64_MIN;
+			entry.trade_id._value = INT64_MIN;
+			entry.md_flags = 0;
+			entry.md_entry_type = 'J';
+			count = 1;
+		}
+		builder.add(root, _entries.data(), uint8_t(count));
+		_messages++;
+	}
+
+	static inline void fill(simba::OrderUpdate& msg, const Order& order) noexcept {
+		msg.md_entry_id = order.id;
+		msg.md_entry_px._value = order.px;
+		msg.md_entry_size = order.size;
+		msg.md_entry_type = order.side;
+	}
+
+	inline const simba::OrderUpdate& finish(simba::OrderUpdate& msg, uint32_t sec, uint64_t flags) noexcept {
+		const Security& security = _securities[sec];
+		msg.md_flags = flags;
+		msg.security_id = security_id(sec);
+		msg.rpt_seq = security.rpt_seq + 1u;
+		return msg;
+	}
+
+};
+
+}; // namespace gen
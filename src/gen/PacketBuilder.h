@@ -0,0 +1,277 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <arpa/inet.h>
+#include <linux/if_ether.h>
+
+#include "../simba/simba.h"
+#include "../ip/procotols/Ethernet.h"
+#include "../ip/procotols/Vlan.h"
+#include "../ip/procotols/IPv4.h"
+#include "../ip/procotols/Udp.h"
+
+namespace gen {
+
+/**
+ * Endpoint is the addresses of the generated frames, the addresses and ports are in the host order.
+ */
+struct Endpoint {
+	uint32_t src_addr = 0x0A000001u; // 10.0.0.1
+	uint32_t dst_addr = 0xEF000001u; // 239.0.0.1
+	uint16_t src_port = 20000u;
+	uint16_t dst_port = 20001u;
+	uint8_t vlans = 0;               // the number of the stacked 802.1Q tags
+};
+
+/**
+ * PacketBuilder writes a SIMBA packet wrapped into Ethernet/[VLAN...]/IPv4/UDP headers:
+ *
+ *   builder.begin(seq, time, true);
+ *   builder.add(update);
+ *   builder.add(execution);
+ *   size_t size;
+ *   const uint8_t* frame = builder.finish(size);
+ *
+ * The SBE messages are little-endian. add() fails if the message doesn't fit into 'mtu' bytes of the IP packet,
+ * 'mtu' is limited by the frame size limit, the jumbo frames are allowed.
+ * The frame is padded to the minimal Ethernet frame size.
+ **/
+class PacketBuilder {
+public:
+
+	static constexpr size_t MAX_VLANS = 8u;
+	static constexpr size_t MIN_FRAME = 64u;
+	static constexpr uint16_t SCHEMA_VERSION = 4u;
+
+protected:
+
+	uint8_t _buffer[pcap::Limits::FRAME_SIZE_LIMIT];
+	Endpoint _endpoint;
+	size_t _mtu;
+	size_t _ip;      // the offset of the IP header
+	size_t _payload; // the offset of the SIMBA packet
+	size_t _size;
+	uint32_t _messages;
+	uint16_t _ip_id;
+
+public:
+
+	PacketBuilder(const PacketBuilder&) = delete;
+	PacketBuilder& operator=(const PacketBuilder&) = delete;
+
+	explicit PacketBuilder(const Endpoint& endpoint = Endpoint(), size_t mtu = 1500u) noexcept :
+		_buffer(),
+		_endpoint(endpoint),
+		_mtu(mtu),
+		_ip(0),
+		_payload(0),
+		_size(0),
+		_messages(0),
+		_ip_id(0) {
+		if(_endpoint.vlans > MAX_VLANS) {
+			_endpoint.vlans = MAX_VLANS;
+		}
+		_ip = sizeof(proto_ip::Ethernet::Header) + _endpoint.vlans * sizeof(proto_ip::Vlan::Header);
+		_payload = _ip + sizeof(proto_ip::IPv4::Header) + sizeof(proto_ip::Udp::Header);
+		if(_mtu > pcap::Limits::FRAME_SIZE_LIMIT - _ip) {
+			_mtu = pcap::Limits::FRAME_SIZE_LIMIT - _ip;
+		}
+	}
+
+	/**
+	 * @return The number of the SBE messages added since begin().
+	 */
+	inline uint32_t messages() const noexcept {
+		return _messages;
+	}
+
+	/**
+	 * Start a packet.
+	 * @param flags - the extra MarketDataPacketHeader::Flags bits.
+	 */
+	void begin(uint32_t msg_seq_num, uint64_t sending_time, bool incremental, uint16_t flags = 0) noexcept {
+		_size = _payload;
+		_messages = 0;
+
+		simba::MarketDataPacketHeader header;
+		header.msg_seq_num = msg_seq_num;
+		header.msg_size = 0;
+		header.msg_flags = uint16_t(flags | bit(simba::MarketDataPacketHeader::Flags::LastFragment));
+		if(incremental) {
+			header.msg_flags |= bit(simba::MarketDataPacketHeader::Flags::IncrementalPacket);
+		}
+		header.sending_time = sending_time;
+		put(header);
+
+		if(incremental) {
+			simba::IncrementalHeader incremental_header;
+			incremental_header.transact_time = sending_time;
+			incremental_header.exchange_trading_session_id = 0;
+			put(incremental_header);
+		}
+	}
+
+	inline bool add(const simba::OrderUpdate& msg) noexcept {
+		return fits(sizeof(simba::SBEMessageHeader) + sizeof(msg))
+		       && (put_message_header(simba::TemplateId::OrderUpdate, sizeof(msg)), put(msg), true);
+	}
+
+	inline bool add(const simba::OrderExecution& msg) noexcept {
+		return fits(sizeof(simba::SBEMessageHeader) + sizeof(msg))
+		       && (put_message_header(simba::TemplateId::OrderExecution, sizeof(msg)), put(msg), true);
+	}
+
+	inline bool add(const simba::EmptyBook& msg) noexcept {
+		return fits(sizeof(simba::SBEMessageHeader) + sizeof(msg))
+		       && (put_message_header(simba::TemplateId::EmptyBook, sizeof(msg)), put(msg), true);
+	}
+
+	inline bool add(const simba::SecurityStatus& msg) noexcept {
+		return fits(sizeof(simba::SBEMessageHeader) + sizeof(msg))
+		       && (put_message_header(simba::TemplateId::SecurityStatus, sizeof(msg)), put(msg), true);
+	}
+
+	inline bool add(const simba::TradingSessionStatus& msg) noexcept {
+		return fits(sizeof(simba::SBEMessageHeader) + sizeof(msg))
+		       && (put_message_header(simba::TemplateId::TradingSessionStatus, sizeof(msg)), put(msg), true);
+	}
+
+	/**
+	 * Add an OrderBookSnapshot message with @count entries.
+	 */
+	bool add(const simba::OrderBookSnapshotRoot& root, const simba::OrderBookSnapshotEntry* entries,
+	         uint8_t count) noexcept {
+		const size_t size = sizeof(simba::SBEMessageHeader) + sizeof(root) + sizeof(simba::GroupSize)
+		                    + count * sizeof(simba::OrderBookSnapshotEntry);
+		if(not fits(size)) {
+			return false;
+		}
+		put_message_header(simba::TemplateId::OrderBookSnapshot, sizeof(root));
+		put(root);
+		simba::GroupSize group;
+		group.block_length = sizeof(simba::OrderBookSnapshotEntry);
+		group.num_in_group = count;
+		put(group);
+		for(uint8_t idx = 0; idx < count; ++idx) {
+			put(entries[idx]);
+		}
+		return true;
+	}
+
+	/**
+	 * @return The number of the entries of an OrderBookSnapshot which fit into an empty packet.
+	 */
+	inline size_t snapshot_capacity() const noexcept {
+		const size_t fixed = sizeof(proto_ip::IPv4::Header) + sizeof(proto_ip::Udp::Header)
+		                     + sizeof(simba::MarketDataPacketHeader) + sizeof(simba::SBEMessageHeader)
+		                     + sizeof(simba::OrderBookSnapshotRoot) + sizeof(simba::GroupSize);
+		const size_t entries = _mtu > fixed ? (_mtu - fixed) / sizeof(simba::OrderBookSnapshotEntry) : 0;
+		return entries < 255u ? entries : 255u;
+	}
+
+	/**
+	 * Complete the headers of the packet.
+	 * @param size - the frame size.
+	 * @return The frame.
+	 */
+	const uint8_t* finish(size_t& size) noexcept {
+		const uint16_t simba_size = uint16_t(_size - _payload);
+		simba::MarketDataPacketHeader* header = reinterpret_cast<simba::MarketDataPacketHeader*>(_buffer + _payload);
+		header->msg_size = simba_size;
+#if __BYTE_ORDER == __BIG_ENDIAN
+		header->msg_size = __builtin_bswap16(header->msg_size);
+#endif
+
+		uint8_t* ptr = _buffer;
+		static const uint8_t dst_mac[ETH_ALEN] = {0x01, 0x00, 0x5E, 0x00, 0x00, 0x01};
+		static const uint8_t src_mac[ETH_ALEN] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+		memcpy(ptr, dst_mac, ETH_ALEN);
+		memcpy(ptr + ETH_ALEN, src_mac, ETH_ALEN);
+		ptr += 2u * ETH_ALEN;
+		for(uint8_t vlan = 0; vlan < _endpoint.vlans; ++vlan) {
+			ptr = put_be16(ptr, ETH_P_8021Q);
+			ptr = put_be16(ptr, uint16_t(100u + vlan)); // the VLAN id, the priority is 0
+		}
+		ptr = put_be16(ptr, ETH_P_IP);
+
+		const uint16_t udp_size = uint16_t(sizeof(proto_ip::Udp::Header) + simba_size);
+		const uint16_t ip_size = uint16_t(sizeof(proto_ip::IPv4::Header) + udp_size);
+		proto_ip::IPv4::Header ip;
+		memset(&ip, 0, sizeof(ip));
+		ip.version = 4;
+		ip.ihl = sizeof(ip) / 4u;
+		ip.tot_len = htons(ip_size);
+		ip.id = htons(_ip_id++);
+		ip.ttl = 64;
+		ip.protocol = proto_ip::IPv4::PROTO_UDP;
+		ip.saddr = htonl(_endpoint.src_addr);
+		ip.daddr = htonl(_endpoint.dst_addr);
+		ip.check = checksum(&ip, sizeof(ip));
+		memcpy(_buffer + _ip, &ip, sizeof(ip));
+
+		proto_ip::Udp::Header udp;
+		udp.source = htons(_endpoint.src_port);
+		udp.dest = htons(_endpoint.dst_port);
+		udp.len = htons(udp_size);
+		udp.check = 0;
+		memcpy(_buffer + _ip + sizeof(ip), &udp, sizeof(udp));
+
+		if(_size < MIN_FRAME) {
+			memset(_buffer + _size, 0, MIN_FRAME - _size);
+			_size = MIN_FRAME;
+		}
+		size = _size;
+		return _buffer;
+	}
+
+protected:
+
+	static inline uint16_t bit(simba::MarketDataPacketHeader::Flags flag) noexcept {
+		return uint16_t(1u << static_cast<uint16_t>(flag));
+	}
+
+	inline bool fits(size_t size) const noexcept {
+		return _size - _ip + size <= _mtu;
+	}
+
+	inline void put_message_header(simba::TemplateId template_id, size_t block_length) noexcept {
+		simba::SBEMessageHeader header;
+		header.block_length = uint16_t(block_length);
+		header.template_id = template_id;
+		header.schema_id = simba::SchemaId::Default;
+		header.version = SCHEMA_VERSION;
+		put(header);
+		_messages++;
+	}
+
+	template <typename T>
+	inline void put(T value) noexcept {
+#if __BYTE_ORDER == __BIG_ENDIAN
+		value.swap_endian();
+#endif
+		memcpy(_buffer + _size, &value, sizeof(value));
+		_size += sizeof(value);
+	}
+
+	static inline uint8_t* put_be16(uint8_t* ptr, uint16_t value) noexcept {
+		const uint16_t be = htons(value);
+		memcpy(ptr, &be, sizeof(be));
+		return ptr + sizeof(be);
+	}
+
+	static uint16_t checksum(const void* data, size_t size) noexcept {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint32_t sum = 0;
+		for(size_t idx = 0; idx + 1u < size; idx += 2u) {
+			sum += uint32_t(bytes[idx] << 8u | bytes[idx + 1u]);
+		}
+		while(sum >> 16u) {
+			sum = (sum & 0xFFFFu) + (sum >> 16u);
+		}
+		return htons(uint16_t(~sum));
+	}
+
+};
+
+}; // namespace gen
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "MarketGenerator.h"
+
+namespace gen {
+
+/**
+ * RateProfile spaces the packets in time at the average 'rate' packets per second:
+ *   constant - the packets are evenly spaced;
+ *   poisson  - the gaps are exponential, the packets are the Poisson process;
+ *   burst:N  - N packets of the same timestamp, then the gap of N average gaps.
+ **/
+class RateProfile {
+public:
+
+	enum class Shape : uint8_t {
+		Constant,
+		Poisson,
+		Burst
+	};
+
+protected:
+
+	Shape _shape;
+	double _interval; // the average gap in nanoseconds
+	uint32_t _burst;
+	uint32_t _sent;   // the packets of the current burst
+	double _carry;    // the fraction of a nanosecond not returned yet
+	Random _random;
+
+public:
+
+	RateProfile(Shape shape, uint64_t rate, uint32_t burst, uint64_t seed) noexcept :
+		_shape(shape),
+		_interval(1e9 / double(rate ? rate : 1u)),
+		_burst(burst ? burst : 1u),
+		_sent(0),
+		_carry(0),
+		_random(seed) {}
+
+	/**
+	 * Parse "constant", "poisson" or "burst:N".
+	 */
+	static bool parse(const char* spec, Shape& shape, uint32_t& burst) noexcept {
+		if(strcmp(spec, "constant") == 0) {
+			shape = Shape::Constant;
+		} else if(strcmp(spec, "poisson") == 0) {
+			shape = Shape::Poisson;
+		} else if(strncmp(spec, "burst:", 6u) == 0) {
+			char* end;
+			burst = uint32_t(strtoul(spec + 6u, &end, 10));
+			if(burst == 0 || *end != '\0') {
+				return false;
+			}
+			shape = Shape::Burst;
+		} else {
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @return The nanoseconds to the next packet.
+	 */
+	inline uint64_t next() noexcept {
+		switch(_shape) {
+			case Shape::Poisson: {
+				const double u = double(_random.next() >> 11u) * 0x1.0p-53;
+				_carry += -std::log1p(-u) * _interval;
+				break;
+			}
+			case Shape::Burst:
+				if(++_sent < _burst) {
+					return 0;
+				}
+				_sent = 0;
+				_carry += _interval * _burst;
+				break;
+			default:
+				_carry += _interval;
+		}
+		const uint64_t gap = uint64_t(_carry);
+		_carry -= double(gap);
+		return gap;
+	}
+
+};
+
+}; // namespace gen
@@ -0,0 +1,316 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <chrono>
+
+#include "pcap/Writer.h"
+#include "gen/MarketGenerator.h"
+#include "gen/RateProfile.h"
+
+struct GenOptions {
+	const char* file_name = nullptr;
+	uint64_t packets = 0;              // 0 - 100000, or no limit with --size
+	uint64_t size = 0;                 // the file size limit in bytes, 0 - none
+	gen::MarketConfig market;
+	gen::Endpoint endpoint;
+	size_t mtu = 1500u;
+	uint64_t rate = 100000u;           // packets per second
+	gen::RateProfile::Shape shape = gen::RateProfile::Shape::Constant;
+	uint32_t burst = 1u;
+	uint64_t start = 1600000000000000000ull; // the first sending_time
+	uint64_t latency = 20000u;         // the capture timestamp is sending_time + latency
+	double gaps = 0;                   // the percent of the packets dropped
+	double dups = 0;                   // the percent of the packets written twice
+};
+
+void usage(FILE* out, const char* name) noexcept {
+	fprintf(out, "usage: %s [options] file.pcap\n", name);
+	fprintf(out, "  --packets=N           the generated packets (default 100000, no limit with --size)\n");
+	fprintf(out, "  --size=BYTES          stop at the file size, the suffixes K, M and G are allowed\n");
+	fprintf(out, "  --securities=N        the number of the securities (default 16)\n");
+	fprintf(out, "  --first-security=ID   the first security_id (default 1)\n");
+	fprintf(out, "  --mix=N,C,D,E         the weights of New, Change, Delete and OrderExecution (default 27,27,26,20)\n");
+	fprintf(out, "  --max-messages=N      the maximum messages per incremental packet (default 8)\n");
+	fprintf(out, "  --snapshot-every=N    a snapshot packet per N incremental packets, 0 - none (default 100)\n");
+	fprintf(out, "  --book-orders=N       the maximum live orders per security (default 64)\n");
+	fprintf(out, "  --snapshot-entries=N  the maximum entries of an OrderBookSnapshot, at most 255 (default 255)\n");
+	fprintf(out, "  --status-every=N      a SecurityStatus halting or resuming a security per N incremental packets\n");
+	fprintf(out, "  --session-every=N     an EmptyBook and a new TradingSessionStatus per N incremental packets\n");
+	fprintf(out, "  --mtu=N               the maximum IP packet size, the jumbo frames are allowed (default 1500)\n");
+	fprintf(out, "  --vlans=N             the stacked VLAN tags, at most %zu (default 0)\n", gen::PacketBuilder::MAX_VLANS);
+	fprintf(out, "  --rate=N              the packets per second (default 100000)\n");
+	fprintf(out, "  --profile=SHAPE       constant, poisson or burst:N (default constant)\n");
+	fprintf(out, "  --start=NS            the first sending_time (default 1600000000000000000)\n");
+	fprintf(out, "  --latency=NS          the capture timestamp minus sending_time (default 20000)\n");
+	fprintf(out, "  --gaps=PCT            the percent of the packets dropped\n");
+	fprintf(out, "  --dups=PCT            the percent of the packets written twice\n");
+	fprintf(out, "  --seed=N              the random seed (default 1)\n");
+}
+
+/**
+ * Parse a byte count with an optional K, M or G binary suffix.
+ */
+bool parse_size(const char* spec, uint64_t& size) noexcept {
+	char* end;
+	size = strtoull(spec, &end, 10);
+	switch(*end) {
+		case 'K': size <<= 10u; ++end; break;
+		case 'M': size <<= 20u; ++end; break;
+		case 'G': size <<= 30u; ++end; break;
+		default: break;
+	}
+	return end != spec && *end == '\0';
+}
+
+bool parse_mix(const char* spec, gen::MarketConfig& market) noexcept {
+	uint32_t weights[4];
+	const char* ptr = spec;
+	for(size_t idx = 0; idx < 4u; ++idx) {
+		char* end;
+		weights[idx] = uint32_t(strtoul(ptr, &end, 10));
+		if(end == ptr || *end != (idx == 3u ? '\0' : ',')) {
+			return false;
+		}
+		ptr = end + 1;
+	}
+	market.new_weight = weights[0];
+	market.change_weight = weights[1];
+	market.delete_weight = weights[2];
+	market.update_weight = weights[0] + weights[1] + weights[2];
+	market.execution_weight = weights[3];
+	return market.update_weight + market.execution_weight > 0;
+}
+
+bool parse_options(int argc, char** argv, GenOptions& opt) noexcept {
+	enum {
+		OPT_PACKETS = 256,
+		OPT_SIZE,
+		OPT_SECURITIES,
+		OPT_FIRST_SECURITY,
+		OPT_MIX,
+		OPT_MAX_MESSAGES,
+		OPT_SNAPSHOT_EVERY,
+		OPT_BOOK_ORDERS,
+		OPT_SNAPSHOT_ENTRIES,
+		OPT_STATUS_EVERY,
+		OPT_SESSION_EVERY,
+		OPT_MTU,
+		OPT_VLANS,
+		OPT_RATE,
+		OPT_PROFILE,
+		OPT_START,
+		OPT_LATENCY,
+		OPT_GAPS,
+		OPT_DUPS,
+		OPT_SEED,
+	};
+
+	static const option long_options[] = {
+		{"packets", required_argument, nullptr, OPT_PACKETS},
+		{"size", required_argument, nullptr, OPT_SIZE},
+		{"securities", required_argument, nullptr, OPT_SECURITIES},
+		{"first-security", required_argument, nullptr, OPT_FIRST_SECURITY},
+		{"mix", required_argument, nullptr, OPT_MIX},
+		{"max-messages", required_argument, nullptr, OPT_MAX_MESSAGES},
+		{"snapshot-every", required_argument, nullptr, OPT_SNAPSHOT_EVERY},
+		{"book-orders", required_argument, nullptr, OPT_BOOK_ORDERS},
+		{"snapshot-entries", required_argument, nullptr, OPT_SNAPSHOT_ENTRIES},
+		{"status-every", required_argument, nullptr, OPT_STATUS_EVERY},
+		{"session-every", required_argument, nullptr, OPT_SESSION_EVERY},
+		{"mtu", required_argument, nullptr, OPT_MTU},
+		{"vlans", required_argument, nullptr, OPT_VLANS},
+		{"rate", required_argument, nullptr, OPT_RATE},
+		{"profile", required_argument, nullptr, OPT_PROFILE},
+		{"start", required_argument, nullptr, OPT_START},
+		{"latency", required_argument, nullptr, OPT_LATENCY},
+		{"gaps", required_argument, nullptr, OPT_GAPS},
+		{"dups", required_argument, nullptr, OPT_DUPS},
+		{"seed", required_argument, nullptr, OPT_SEED},
+		{"help", no_argument, nullptr, 'h'},
+		{nullptr, 0, nullptr, 0}
+	};
+
+	opt.market.update_weight = 80u;
+	opt.market.execution_weight = 20u;
+	opt.market.new_weight = 27u;
+	opt.market.change_weight = 27u;
+	opt.market.delete_weight = 26u;
+
+	int c;
+	while((c = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+		switch(c) {
+			case OPT_PACKETS:
+				opt.packets = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_SIZE:
+				if(not parse_size(optarg, opt.size)) {
+					fprintf(stderr, "Bad size '%s'\n", optarg);
+					return false;
+				}
+				break;
+
+			case OPT_SECURITIES:
+				opt.market.securities = uint32_t(strtoul(optarg, nullptr, 10));
+				if(opt.market.securities == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_FIRST_SECURITY:
+				opt.market.first_security_id = int32_t(strtol(optarg, nullptr, 10));
+				break;
+
+			case OPT_MIX:
+				if(not parse_mix(optarg, opt.market)) {
+					fprintf(stderr, "Bad mix '%s'\n", optarg);
+					return false;
+				}
+				break;
+
+			case OPT_MAX_MESSAGES:
+				opt.market.max_messages = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_SNAPSHOT_EVERY:
+				opt.market.snapshot_every = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_BOOK_ORDERS:
+				opt.market.book_orders = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_SNAPSHOT_ENTRIES:
+				opt.market.snapshot_entries = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_STATUS_EVERY:
+				opt.market.status_every = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_SESSION_EVERY:
+				opt.market.session_every = uint32_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_MTU:
+				opt.mtu = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_VLANS:
+				opt.endpoint.vlans = uint8_t(strtoul(optarg, nullptr, 10));
+				if(opt.endpoint.vlans > gen::PacketBuilder::MAX_VLANS) {
+					return false;
+				}
+				break;
+
+			case OPT_RATE:
+				opt.rate = strtoull(optarg, nullptr, 10);
+				if(opt.rate == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_PROFILE:
+				if(not gen::RateProfile::parse(optarg, opt.shape, opt.burst)) {
+					fprintf(stderr, "Bad profile '%s'\n", optarg);
+					return false;
+				}
+				break;
+
+			case OPT_START:
+				opt.start = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_LATENCY:
+				opt.latency = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_GAPS:
+				opt.gaps = strtod(optarg, nullptr);
+				break;
+
+			case OPT_DUPS:
+				opt.dups = strtod(optarg, nullptr);
+				break;
+
+			case OPT_SEED:
+				opt.market.seed = strtoull(optarg, nullptr, 10);
+				break;
+
+			default:
+				return false;
+		}
+	}
+
+	if(optind + 1 != argc) {
+		return false;
+	}
+	opt.file_name = argv[optind];
+	if(opt.packets == 0) {
+		opt.packets = opt.size ? UINT64_MAX : 100000u;
+	}
+	return true;
+}
+
+/**
+ * @return The threshold of Random::next() for @percent.
+ */
+static inline uint64_t threshold(double percent) noexcept {
+	if(percent <= 0) {
+		return 0;
+	}
+	return percent >= 100.0 ? UINT64_MAX : uint64_t(percent / 100.0 * 0x1.0p64);
+}
+
+int main(int argc, char** argv) noexcept {
+	GenOptions opt;
+	if(not parse_options(argc, argv, opt)) {
+		usage(stderr, argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	pcap::Writer writer(opt.file_name);
+	if(not writer.open()) {
+		return EXIT_FAILURE;
+	}
+
+	gen::PacketBuilder builder(opt.endpoint, opt.mtu);
+	gen::MarketGenerator market(opt.market);
+	gen::RateProfile profile(opt.shape, opt.rate, opt.burst, opt.market.seed + 1u);
+	gen::Random faults(opt.market.seed + 2u); // the injection doesn't change the generated flow
+	const uint64_t gap_threshold = threshold(opt.gaps);
+	const uint64_t dup_threshold = threshold(opt.dups);
+
+	const auto started = std::chrono::steady_clock::now();
+	uint64_t time = opt.start;
+	uint64_t gaps = 0;
+	uint64_t dups = 0;
+	bool result = true;
+	for(uint64_t idx = 0; idx < opt.packets && (opt.size == 0 || writer.bytes() < opt.size); ++idx) {
+		market.next(builder, time);
+		size_t size;
+		const uint8_t* frame = builder.finish(size);
+
+		if(gap_threshold && faults.next() < gap_threshold) {
+			gaps++;
+		} else {
+			result = writer.write(frame, size, time + opt.latency);
+			if(result && dup_threshold && faults.next() < dup_threshold) {
+				result = writer.write(frame, size, time + opt.latency);
+				dups++;
+			}
+			if(not result) {
+				break;
+			}
+		}
+		time += profile.next();
+	}
+	result = writer.close() && result;
+
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+	fprintf(stderr, "'%s' : frames=%lu messages=%lu bytes=%lu gaps=%lu dups=%lu %.2fs %.0fMB/s\n",
+	        opt.file_name, writer.frames(), market.messages(), writer.bytes(), gaps, dups, elapsed,
+	        double(writer.bytes()) / 1e6 / (elapsed > 0 ? elapsed : 1.0));
+	return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
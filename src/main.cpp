@@ -1,11 +1,95 @@
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <getopt.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include "pcap/Reader.h"
 #include "IpFrameParser.h"
 #include "SimbaParser.h"
+#include "ErrorLog.h"
+#include "Profile.h"
+#include "simba/ReorderBuffer.h"
+#include "book/BookBuilder.h"
+#include "shm/TopOfBook.h"
+#include "book/Conflator.h"
+#include "book/ShardedBookBuilder.h"
+#include "book/Checkpoint.h"
+#include "columnar/Exporter.h"
+#include "columnar/TableReader.h"
+#include "simba/RecordHandler.h"
+#include "simba/StatsHandler.h"
+#include "simba/BurstAnalyzer.h"
+#include "simba/BarBuilder.h"
+#include "simba/SecurityFilter.h"
+#include "output/AsyncWriter.h"
+#include "net/UdpSender.h"
+#include "net/Pacer.h"
+
+struct Options {
+	const char* file_name = nullptr;
+	size_t reorder_window = 0;       // 0 - reordering is disabled
+	uint64_t reorder_delay = 1000000; // nanoseconds of the capture time
+	size_t reorder_depth = SIZE_MAX;
+	size_t depth = 0;                // 0 - the L2 depth mode is disabled
+	const char* shm_name = nullptr;  // publish the top of the books into the shared memory
+	const char* shm_dump = nullptr;  // print the top of the books published by another process
+	uint32_t capacity = 4096;        // the maximum number of securities
+	uint64_t conflate = 0;           // the conflated consumer period in microseconds, 0 - disabled
+	size_t threads = 0;              // the number of book workers, 0 - books are built on the decode thread
+	size_t ring_capacity = 65536;
+	bool barrier_eot = false;
+	const char* export_dir = nullptr;    // write the messages into the columnar table files
+	uint32_t export_chunk = 65536;       // rows per chunk of the table files
+	bool export_dict = false;
+	const char* export_info = nullptr;   // print the schema and the chunk stats of a table file
+	bool records = false;                // write the rows in the formats selected per table
+	simba::RecordFormats formats = {};
+	bool split = false;                  // write the rows to a file per key
+	simba::SplitOutput::Key split_key = simba::SplitOutput::Key::SecurityId;
+	const char* split_dir = ".";
+	size_t max_open = 256;               // the maximum number of open files of the split output
+	size_t split_chunk = 64u << 10u;     // bytes buffered per file of the split output
+	const char* output = nullptr;        // the text output file, stdout by default
+	uint32_t async = 0;                  // the number of buffers of the writer thread, 0 - synchronous writes
+	size_t async_buffer = 1u << 20u;
+	bool direct = false;                 // write the output file with O_DIRECT
+	bool stats = false;                  // only count the messages and print the summary
+	bool mmap = false;                   // read the capture mapped into memory
+	size_t error_samples = 8;            // the frame indices kept per drop reason
+	uint64_t error_interval = 0;         // print the drop summary every N seconds, 0 - at exit only
+	uint64_t burst_windows[simba::BurstAnalyzer::MAX_WINDOWS] = {}; // the burst window sizes in nanoseconds
+	size_t bursts = 0;                   // the number of the burst windows, 0 - the burst analysis is disabled
+	size_t burst_top = 10;
+	uint64_t bar_intervals[simba::BarBuilder::MAX_INTERVALS] = {}; // the bar intervals in nanoseconds
+	size_t bars = 0;                     // the number of the bar intervals, 0 - the bars are disabled
+	const char* replay = nullptr;        // send the UDP payloads to ADDR:PORT
+	double speed = 1.0;                  // the replay speed, 0 - as fast as possible
+	size_t replay_batch = 32;            // the datagrams per sendmmsg()
+	uint64_t replay_spin = 50000;        // nanoseconds spun before a datagram is due
+	const char* multicast_if = nullptr;
+	uint8_t ttl = 1;
+	const char* checkpoint_dir = nullptr; // the directory of the book checkpoints
+	uint64_t checkpoint_every = 0;       // save a checkpoint every N nanoseconds of sending_time, 0 - never
+	uint64_t resume_frame = UINT64_MAX;  // resume from the latest checkpoint at or before the frame
+	uint64_t resume_time = UINT64_MAX;   // resume from the latest checkpoint at or before the sending_time
+	bool resume = false;
+	bool query = false;                  // print the book of a security at a sending_time
+	uint64_t query_time = 0;             // nanoseconds since the epoch or of the day with 'query_time_of_day'
+	bool query_time_of_day = false;
+	int32_t query_security = 0;
+	bool query_security_set = false;
+	bool query_csv = false;
+	simba::SecurityFilter filter;        // decode the order messages of these securities only, empty - all
+};
 
 bool extract_udp_payload(pcap::Frame& frame) noexcept {
+	SIMBA_PROFILE_SPAN(Ip);
 	bool result = false;
 	IpFrameParser parser(frame);
 	auto proto = parser.protocol();
@@ -22,29 +106,1110 @@ bool extract_udp_payload(pcap::Frame& frame) noexcept {
 	return result;
 }
 
+void dump_packet(output::TextBuffer& out, pcap::Frame& frame, ErrorLog& errors,
+                 simba::SecurityFilter* filter) noexcept {
+	SimbaParser parser(frame, filter);
+	if(not parser.dump(out)) {
+		errors.report(frame, parser.error(), parser.detail());
+	}
+	out.append_char('\n');
+}
+
+template <typename Handler>
+void parse_packet(pcap::Frame& frame, Handler& handler, ErrorLog& errors, simba::SecurityFilter* filter) noexcept {
+	SimbaParser parser(frame, filter);
+	if(not parser.parse(handler)) {
+		errors.report(frame, parser.error(), parser.detail());
+	}
+}
+
+/**
+ * Prints the changed levels of the L2 depth views.
+ */
+struct DepthPrinter {
+	FILE* out;
+	uint32_t mask; // the levels to print
+
+	void on_book_update(book::Security& sec, const book::DepthView::Changes& changes) noexcept {
+		const book::DepthView::Changes visible{changes.bids & mask, changes.asks & mask};
+		if(not visible.empty()) {
+			fprintf(out, "Book [security_id=%d orders=%zu] | ", sec.id, sec.orders());
+			sec.depth.dump(out, visible);
+		}
+	}
+
+	void on_book_cleared(book::Security& sec) noexcept {
+		fprintf(out, "Book [security_id=%d orders=%zu] | cleared\n", sec.id, sec.orders());
+	}
+};
+
+/**
+ * Passes the book updates to the enabled consumers.
+ */
+struct BookListener {
+	DepthPrinter* printer;
+	shm::TopOfBookPublisher* publisher;
+	book::Conflator* conflator;
+
+	void on_book_update(book::Security& sec, const book::DepthView::Changes& changes) noexcept {
+		if(printer) {
+			printer->on_book_update(sec, changes);
+		}
+		if(publisher) {
+			publisher->on_book_update(sec, changes);
+		}
+		if(conflator) {
+			conflator->on_book_update(sec, changes);
+		}
+	}
+
+	void on_book_cleared(book::Security& sec) noexcept {
+		if(printer) {
+			printer->on_book_cleared(sec);
+		}
+		if(publisher) {
+			publisher->on_book_cleared(sec);
+		}
+		if(conflator) {
+			conflator->on_book_cleared(sec);
+		}
+	}
+};
+
+/**
+ * Sends the UDP payloads at the capture time offsets, the datagrams which are due are sent in a batch.
+ */
+class Replayer {
+	net::UdpSender& _sender;
+	net::Pacer& _pacer;
+	std::vector<uint64_t> _due; // the scheduled time of the queued datagrams
+	bool _failed;
+
+public:
+
+	Replayer(net::UdpSender& sender, net::Pacer& pacer, size_t batch) noexcept :
+		_sender(sender),
+		_pacer(pacer),
+		_due(batch),
+		_failed(false) {}
+
+	void send(const pcap::Frame& frame) noexcept {
+		if(_failed) {
+			return;
+		}
+		const uint64_t due = _pacer.schedule(frame.timestamp());
+		if(_sender.size() && (_sender.size() == _due.size() || due > net::Pacer::now())) {
+			flush();
+		}
+		_pacer.wait(due);
+		_due[_sender.size()] = due;
+		_sender.add(frame.head(), frame.available());
+	}
+
+	/**
+	 * @return false - in case of a send error.
+	 */
+	bool flush() noexcept {
+		const size_t count = _sender.size();
+		_failed = _failed || not _sender.flush();
+		const uint64_t sent = net::Pacer::now();
+		for(size_t idx = 0; idx < count; ++idx) {
+			_pacer.record(_due[idx], sent);
+		}
+		return not _failed;
+	}
+};
+
+/**
+ * Write all the price levels of the book, a line per level:
+ *   text - "bid[0] 999.98 48 1", the price, the size and the number of orders;
+ *   csv  - "security_id,time,side,level,price,size,count".
+ */
+void write_book(output::TextBuffer& out, const book::Security& sec, uint64_t time, bool csv) noexcept {
+	const auto& bids = sec.book.levels(book::Side::Bid);
+	const auto& asks = sec.book.levels(book::Side::Ask);
+	if(csv) {
+		out.append("security_id,time,side,level,price,size,count\n");
+	} else {
+		out.append("Book [ security_id=").append_int(sec.id);
+		out.append(" time=").append_uint(time);
+		out.append(" rpt_seq=").append_uint(sec.rpt_seq);
+		out.append(" update_time=").append_uint(sec.update_time);
+		out.append(" orders=").append_uint(sec.orders());
+		out.append(" bids=").append_uint(bids.size());
+		out.append(" asks=").append_uint(asks.size()).append(" ]\n");
+	}
+
+	const auto write_side = [&out, &sec, time, csv](const char* side, const book::OrderBook::Levels& levels) {
+		uint64_t idx = 0;
+		for(const auto& level : levels) {
+			if(csv) {
+				out.append_int(sec.id).append_char(',').append_uint(time).append_char(',');
+				out.append_str(side).append_char(',').append_uint(idx).append_char(',');
+			} else {
+				out.append("  ").append_str(side).append_char('[').append_uint(idx).append("] ");
+			}
+			const char separator = csv ? ',' : ' ';
+			out.append_decimal(level.second.price, simba::Decimal5::DIVISOR).append_char(separator);
+			out.append_int(level.second.size).append_char(separator);
+			out.append_uint(level.second.count).append_char('\n');
+			++idx;
+		}
+	};
+	write_side("bid", bids);
+	write_side("ask", asks);
+}
+
+void usage(FILE* out, const char* name) noexcept {
+	fprintf(out, "usage: %s [options] [pcap-file]\n", name);
+	fprintf(out, "       %s --shm-dump=NAME\n", name);
+	fprintf(out, "       %s --export-info=FILE\n", name);
+	fprintf(out, "  --reorder=N          restore the msg_seq_num order of incremental packets within N packets\n");
+	fprintf(out, "  --reorder-delay=US   skip a hole after US microseconds of the capture time (default 1000)\n");
+	fprintf(out, "  --reorder-depth=N    skip a hole when N packets are waiting for it (default is the --reorder window)\n");
+	fprintf(out, "  --depth=N            build the books and print the changed levels of the top N (max %zu) levels\n",
+	        book::DepthView::MAX_DEPTH);
+	fprintf(out, "  --shm=NAME           publish the top %u levels of the books into the POSIX shared memory object\n",
+	        shm::TOB_LEVELS);
+	fprintf(out, "  --shm-dump=NAME      print the top of the books published into the shared memory object\n");
+	fprintf(out, "  --conflate=US        print the changed top of the books from a conflating consumer every US microseconds\n");
+	fprintf(out, "  --capacity=N         the maximum number of securities for --shm and --conflate (default 4096)\n");
+	fprintf(out, "  --threads=N          build the books on N worker threads sharded by security_id (with --shm only)\n");
+	fprintf(out, "  --ring=N             the number of messages queued to a book worker (default 65536)\n");
+	fprintf(out, "  --barrier-eot        wait for all the book workers at every EndOfTransaction flag\n");
+	fprintf(out, "  --export=DIR         write the messages of every template into a columnar table file in DIR\n");
+	fprintf(out, "  --export-chunk=N     the number of rows per chunk of the table files (default 65536)\n");
+	fprintf(out, "  --export-dict        dictionary encode security_id in the table files\n");
+	fprintf(out, "  --export-info=FILE   print the schema and the chunk stats of a table file\n");
+	fprintf(out, "  --format=SPEC        write a row per message: FORMAT or TABLE:FORMAT[,TABLE:FORMAT...],\n");
+	fprintf(out, "                       FORMAT is csv, ndjson or none, TABLE is OrderUpdate, OrderExecution\n");
+	fprintf(out, "                       or OrderBookSnapshot, the tables which are not listed are not written,\n");
+	fprintf(out, "                       several CSV tables are written with --split=template only\n");
+	fprintf(out, "  --split=KEY          write the --format rows to a file per KEY: security_id or template\n");
+	fprintf(out, "  --split-dir=DIR      the directory of the split files (default .)\n");
+	fprintf(out, "  --split-chunk=KB     kilobytes buffered per split file and written at once (default 64)\n");
+	fprintf(out, "  --max-open=N         the maximum number of open split files (default 256)\n");
+	fprintf(out, "  --output=FILE        write the text dump or the --format rows to FILE instead of stdout\n");
+	fprintf(out, "  --async=N            write the output on a writer thread through N buffers (at least 2)\n");
+	fprintf(out, "  --async-buffer=KB    the size of an --async buffer in kilobytes (default 1024)\n");
+	fprintf(out, "  --direct             write the --output file with O_DIRECT (with --async only)\n");
+	fprintf(out, "  --stats              only count the messages per template, action, flag and security and the drops\n");
+	fprintf(out, "  --mmap               read the capture mapped into memory\n");
+	fprintf(out, "  --error-samples=N    the frame indices kept per drop reason in the summary (default 8)\n");
+	fprintf(out, "  --error-interval=S   print the drop summary every S seconds besides the exit\n");
+	fprintf(out, "  --bursts=LIST        only measure the message rates in up to %zu window sizes, e.g. 1us,100us,1ms\n",
+	        simba::BurstAnalyzer::MAX_WINDOWS);
+	fprintf(out, "  --burst-top=N        the number of the largest --bursts windows reported (default 10)\n");
+	fprintf(out, "  --bars=LIST          write the OHLCV and VWAP bars of every security in up to %zu intervals, e.g. 1s,1m\n",
+	        simba::BarBuilder::MAX_INTERVALS);
+	fprintf(out, "  --replay=ADDR:PORT   send the UDP payloads to the address at the capture timing\n");
+	fprintf(out, "  --speed=X            the --replay speed, 2 - twice as fast, 0 - as fast as possible (default 1)\n");
+	fprintf(out, "  --replay-batch=N     the datagrams per sendmmsg() call (default 32)\n");
+	fprintf(out, "  --replay-spin=US     spin for the last US microseconds before a datagram is due (default 50)\n");
+	fprintf(out, "  --multicast-if=ADDR  the address of the interface to send the multicast datagrams from\n");
+	fprintf(out, "  --ttl=N              the multicast TTL (default 1)\n");
+	fprintf(out, "  --checkpoint-dir=DIR the directory of the book checkpoints\n");
+	fprintf(out, "  --checkpoint-every=T build the books and save a checkpoint every T of sending_time, e.g. 10m\n");
+	fprintf(out, "  --resume-frame=N     build the books from the latest checkpoint at or before the frame N\n");
+	fprintf(out, "  --resume-time=NS     build the books from the latest checkpoint at or before the sending_time\n");
+	fprintf(out, "  --book-at=TIME       print the book of --security at the sending_time, TIME is nanoseconds since\n");
+	fprintf(out, "                       the epoch or HH:MM:SS[.fraction] UTC of the day of the capture\n");
+	fprintf(out, "  --security=ID        the security_id of --book-at\n");
+	fprintf(out, "  --book-format=FMT    the --book-at output: text or csv (default text)\n");
+	fprintf(out, "  --securities=LIST    decode the order messages of the listed security_id only, e.g. 2304587,2304601\n");
+}
+
+/**
+ * Parse nanoseconds since the epoch or the time of the day "HH:MM:SS[.fraction]".
+ * @param time_of_day - the result is nanoseconds of the day.
+ */
+bool parse_time(const char* spec, uint64_t& time, bool& time_of_day) noexcept {
+	char* end;
+	time_of_day = strchr(spec, ':') != nullptr;
+	if(not time_of_day) {
+		time = strtoull(spec, &end, 10);
+		return end != spec && *end == '\0';
+	}
+
+	unsigned hours;
+	unsigned minutes;
+	unsigned seconds;
+	int length = 0;
+	if(sscanf(spec, "%2u:%2u:%2u%n", &hours, &minutes, &seconds, &length) != 3 || hours > 23u || minutes > 59u
+	   || seconds > 59u) {
+		return false;
+	}
+	time = ((hours * 60ull + minutes) * 60ull + seconds) * 1000000000ull;
+	const char* fraction = spec + length;
+	if(*fraction == '.') {
+		uint64_t scale = 100000000ull;
+		for(++fraction; *fraction >= '0' && *fraction <= '9' && scale; ++fraction, scale /= 10u) {
+			time += uint64_t(*fraction - '0') * scale;
+		}
+	}
+	return *fraction == '\0';
+}
+
+/**
+ * Parse a comma separated list of durations, a number with the 'ns', 'us', 'ms', 's' or 'm' suffix each.
+ * @param durations - the array of @max nanosecond values to fill.
+ * @return The number of the durations, 0 - @spec is malformed.
+ */
+size_t parse_durations(const char* spec, uint64_t* durations, size_t max) noexcept {
+	static const struct {
+		const char* name;
+		uint64_t ns;
+	} units[] = {{"ns", 1u}, {"us", 1000u}, {"ms", 1000000u}, {"s", 1000000000u}, {"m", 60000000000u}};
+
+	size_t count = 0;
+	while(*spec) {
+		const char* end = strchr(spec, ',');
+		if(not end) {
+			end = spec + strlen(spec);
+		}
+		if(count == max) {
+			return 0;
+		}
+
+		char* suffix;
+		const uint64_t value = strtoull(spec, &suffix, 10);
+		const size_t length = size_t(end - suffix);
+		durations[count] = 0;
+		for(const auto& unit : units) {
+			if(length == strlen(unit.name) && memcmp(suffix, unit.name, length) == 0) {
+				durations[count] = value * unit.ns;
+			}
+		}
+		if(durations[count++] == 0) {
+			return 0;
+		}
+		spec = *end ? end + 1 : end;
+	}
+	return count;
+}
+
+bool parse_options(int argc, char** argv, Options& opt) noexcept {
+	enum {
+		OPT_REORDER = 256,
+		OPT_REORDER_DELAY,
+		OPT_REORDER_DEPTH,
+		OPT_DEPTH,
+		OPT_SHM,
+		OPT_SHM_DUMP,
+		OPT_CONFLATE,
+		OPT_CAPACITY,
+		OPT_THREADS,
+		OPT_RING,
+		OPT_BARRIER_EOT,
+		OPT_EXPORT,
+		OPT_EXPORT_CHUNK,
+		OPT_EXPORT_DICT,
+		OPT_EXPORT_INFO,
+		OPT_FORMAT,
+		OPT_SPLIT,
+		OPT_SPLIT_DIR,
+		OPT_SPLIT_CHUNK,
+		OPT_MAX_OPEN,
+		OPT_OUTPUT,
+		OPT_ASYNC,
+		OPT_ASYNC_BUFFER,
+		OPT_DIRECT,
+		OPT_STATS,
+		OPT_MMAP,
+		OPT_ERROR_SAMPLES,
+		OPT_ERROR_INTERVAL,
+		OPT_BURSTS,
+		OPT_BURST_TOP,
+		OPT_BARS,
+		OPT_REPLAY,
+		OPT_SPEED,
+		OPT_REPLAY_BATCH,
+		OPT_REPLAY_SPIN,
+		OPT_MULTICAST_IF,
+		OPT_TTL,
+		OPT_CHECKPOINT_DIR,
+		OPT_CHECKPOINT_EVERY,
+		OPT_RESUME_FRAME,
+		OPT_RESUME_TIME,
+		OPT_BOOK_AT,
+		OPT_SECURITY,
+		OPT_BOOK_FORMAT,
+		OPT_SECURITIES,
+	};
+
+	static const option long_options[] = {
+		{"reorder", required_argument, nullptr, OPT_REORDER},
+		{"reorder-delay", required_argument, nullptr, OPT_REORDER_DELAY},
+		{"reorder-depth", required_argument, nullptr, OPT_REORDER_DEPTH},
+		{"depth", required_argument, nullptr, OPT_DEPTH},
+		{"shm", required_argument, nullptr, OPT_SHM},
+		{"shm-dump", required_argument, nullptr, OPT_SHM_DUMP},
+		{"conflate", required_argument, nullptr, OPT_CONFLATE},
+		{"capacity", required_argument, nullptr, OPT_CAPACITY},
+		{"threads", required_argument, nullptr, OPT_THREADS},
+		{"ring", required_argument, nullptr, OPT_RING},
+		{"barrier-eot", no_argument, nullptr, OPT_BARRIER_EOT},
+		{"export", required_argument, nullptr, OPT_EXPORT},
+		{"export-chunk", required_argument, nullptr, OPT_EXPORT_CHUNK},
+		{"export-dict", no_argument, nullptr, OPT_EXPORT_DICT},
+		{"export-info", required_argument, nullptr, OPT_EXPORT_INFO},
+		{"format", required_argument, nullptr, OPT_FORMAT},
+		{"split", required_argument, nullptr, OPT_SPLIT},
+		{"split-dir", required_argument, nullptr, OPT_SPLIT_DIR},
+		{"split-chunk", required_argument, nullptr, OPT_SPLIT_CHUNK},
+		{"max-open", required_argument, nullptr, OPT_MAX_OPEN},
+		{"output", required_argument, nullptr, OPT_OUTPUT},
+		{"async", required_argument, nullptr, OPT_ASYNC},
+		{"async-buffer", required_argument, nullptr, OPT_ASYNC_BUFFER},
+		{"direct", no_argument, nullptr, OPT_DIRECT},
+		{"stats", no_argument, nullptr, OPT_STATS},
+		{"mmap", no_argument, nullptr, OPT_MMAP},
+		{"error-samples", required_argument, nullptr, OPT_ERROR_SAMPLES},
+		{"error-interval", required_argument, nullptr, OPT_ERROR_INTERVAL},
+		{"bursts", required_argument, nullptr, OPT_BURSTS},
+		{"burst-top", required_argument, nullptr, OPT_BURST_TOP},
+		{"bars", required_argument, nullptr, OPT_BARS},
+		{"replay", required_argument, nullptr, OPT_REPLAY},
+		{"speed", required_argument, nullptr, OPT_SPEED},
+		{"replay-batch", required_argument, nullptr, OPT_REPLAY_BATCH},
+		{"replay-spin", required_argument, nullptr, OPT_REPLAY_SPIN},
+		{"multicast-if", required_argument, nullptr, OPT_MULTICAST_IF},
+		{"ttl", required_argument, nullptr, OPT_TTL},
+		{"checkpoint-dir", required_argument, nullptr, OPT_CHECKPOINT_DIR},
+		{"checkpoint-every", required_argument, nullptr, OPT_CHECKPOINT_EVERY},
+		{"resume-frame", required_argument, nullptr, OPT_RESUME_FRAME},
+		{"resume-time", required_argument, nullptr, OPT_RESUME_TIME},
+		{"book-at", required_argument, nullptr, OPT_BOOK_AT},
+		{"security", required_argument, nullptr, OPT_SECURITY},
+		{"book-format", required_argument, nullptr, OPT_BOOK_FORMAT},
+		{"securities", required_argument, nullptr, OPT_SECURITIES},
+		{"help", no_argument, nullptr, 'h'},
+		{nullptr, 0, nullptr, 0}
+	};
+
+	int c;
+	while((c = getopt_long(argc, argv, "h", long_options, nullptr)) != -1) {
+		switch(c) {
+			case OPT_REORDER:
+				opt.reorder_window = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_REORDER_DELAY:
+				opt.reorder_delay = strtoull(optarg, nullptr, 10) * 1000ull;
+				break;
+
+			case OPT_REORDER_DEPTH:
+				opt.reorder_depth = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_DEPTH:
+				opt.depth = strtoull(optarg, nullptr, 10);
+				if(opt.depth == 0 || opt.depth > book::DepthView::MAX_DEPTH) {
+					return false;
+				}
+				break;
+
+			case OPT_SHM:
+				opt.shm_name = optarg;
+				break;
+
+			case OPT_SHM_DUMP:
+				opt.shm_dump = optarg;
+				break;
+
+			case OPT_CONFLATE:
+				opt.conflate = strtoull(optarg, nullptr, 10);
+				if(opt.conflate == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_CAPACITY:
+				opt.capacity = uint32_t(strtoul(optarg, nullptr, 10));
+				if(opt.capacity == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_THREADS:
+				opt.threads = strtoull(optarg, nullptr, 10);
+				if(opt.threads == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_RING:
+				opt.ring_capacity = strtoull(optarg, nullptr, 10);
+				if(opt.ring_capacity == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_BARRIER_EOT:
+				opt.barrier_eot = true;
+				break;
+
+			case OPT_EXPORT:
+				opt.export_dir = optarg;
+				break;
+
+			case OPT_EXPORT_CHUNK:
+				opt.export_chunk = uint32_t(strtoul(optarg, nullptr, 10));
+				if(opt.export_chunk == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_EXPORT_DICT:
+				opt.export_dict = true;
+				break;
+
+			case OPT_EXPORT_INFO:
+				opt.export_info = optarg;
+				break;
+
+			case OPT_FORMAT:
+				if(not simba::parse_record_formats(optarg, opt.formats)) {
+					return false;
+				}
+				opt.records = true;
+				break;
+
+			case OPT_SPLIT:
+				if(strcmp(optarg, "security_id") == 0) {
+					opt.split_key = simba::SplitOutput::Key::SecurityId;
+				} else if(strcmp(optarg, "template") == 0) {
+					opt.split_key = simba::SplitOutput::Key::Template;
+				} else {
+					return false;
+				}
+				opt.split = true;
+				break;
+
+			case OPT_SPLIT_DIR:
+				opt.split_dir = optarg;
+				break;
+
+			case OPT_SPLIT_CHUNK:
+				opt.split_chunk = strtoull(optarg, nullptr, 10) << 10u;
+				if(opt.split_chunk == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_MAX_OPEN:
+				opt.max_open = strtoull(optarg, nullptr, 10);
+				if(opt.max_open == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_OUTPUT:
+				opt.output = optarg;
+				break;
+
+			case OPT_ASYNC:
+				opt.async = uint32_t(strtoul(optarg, nullptr, 10));
+				if(opt.async < 2u) {
+					return false;
+				}
+				break;
+
+			case OPT_ASYNC_BUFFER:
+				opt.async_buffer = strtoull(optarg, nullptr, 10) << 10u;
+				if(opt.async_buffer == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_DIRECT:
+				opt.direct = true;
+				break;
+
+			case OPT_STATS:
+				opt.stats = true;
+				break;
+
+			case OPT_MMAP:
+				opt.mmap = true;
+				break;
+
+			case OPT_ERROR_SAMPLES:
+				opt.error_samples = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_ERROR_INTERVAL:
+				opt.error_interval = strtoull(optarg, nullptr, 10);
+				if(opt.error_interval == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_BURSTS:
+				opt.bursts = parse_durations(optarg, opt.burst_windows, simba::BurstAnalyzer::MAX_WINDOWS);
+				if(opt.bursts == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_BURST_TOP:
+				opt.burst_top = strtoull(optarg, nullptr, 10);
+				break;
+
+			case OPT_BARS:
+				opt.bars = parse_durations(optarg, opt.bar_intervals, simba::BarBuilder::MAX_INTERVALS);
+				if(opt.bars == 0) {
+					return false;
+				}
+				break;
+
+			case OPT_REPLAY:
+				opt.replay = optarg;
+				break;
+
+			case OPT_SPEED:
+				opt.speed = strtod(optarg, nullptr);
+				if(opt.speed < 0) {
+					return false;
+				}
+				break;
+
+			case OPT_REPLAY_BATCH:
+				opt.replay_batch = strtoull(optarg, nullptr, 10);
+				if(opt.replay_batch == 0 || opt.replay_batch > net::UdpSender::MAX_BATCH) {
+					return false;
+				}
+				break;
+
+			case OPT_REPLAY_SPIN:
+				opt.replay_spin = strtoull(optarg, nullptr, 10) * 1000ull;
+				break;
+
+			case OPT_MULTICAST_IF:
+				opt.multicast_if = optarg;
+				break;
+
+			case OPT_TTL:
+				opt.ttl = uint8_t(strtoul(optarg, nullptr, 10));
+				break;
+
+			case OPT_CHECKPOINT_DIR:
+				opt.checkpoint_dir = optarg;
+				break;
+
+			case OPT_CHECKPOINT_EVERY:
+				if(parse_durations(optarg, &opt.checkpoint_every, 1u) != 1u) {
+					return false;
+				}
+				break;
+
+			case OPT_RESUME_FRAME:
+				opt.resume_frame = strtoull(optarg, nullptr, 10);
+				opt.resume = true;
+				break;
+
+			case OPT_RESUME_TIME:
+				opt.resume_time = strtoull(optarg, nullptr, 10);
+				opt.resume = true;
+				break;
+
+			case OPT_BOOK_AT:
+				if(not parse_time(optarg, opt.query_time, opt.query_time_of_day)) {
+					fprintf(stderr, "Bad time '%s'\n", optarg);
+					return false;
+				}
+				opt.query = true;
+				break;
+
+			case OPT_SECURITY:
+				opt.query_security = int32_t(strtol(optarg, nullptr, 10));
+				opt.query_security_set = true;
+				break;
+
+			case OPT_BOOK_FORMAT:
+				if(strcmp(optarg, "csv") == 0) {
+					opt.query_csv = true;
+				} else if(strcmp(optarg, "text") != 0) {
+					return false;
+				}
+				break;
+
+			case OPT_SECURITIES:
+				if(not opt.filter.parse(optarg)) {
+					return false;
+				}
+				break;
+
+			default:
+				return false;
+		}
+	}
+
+	if(opt.shm_dump || opt.export_info) {
+		return optind == argc;
+	}
+
+	if(opt.export_dir && (opt.threads || opt.depth || opt.shm_name || opt.conflate)) {
+		fprintf(stderr, "--export might not be used with the book options\n");
+		return false;
+	}
+
+	if(opt.records && (opt.export_dir || opt.threads || opt.depth || opt.shm_name || opt.conflate)) {
+		fprintf(stderr, "--format might not be used with --export and the book options\n");
+		return false;
+	}
+
+	if((opt.stats || opt.bursts) && (opt.records || opt.export_dir || opt.threads || opt.depth || opt.shm_name
+	                                 || opt.conflate || opt.output || opt.async)) {
+		fprintf(stderr, "--stats and --bursts might not be used with the other output options\n");
+		return false;
+	}
+
+	if(opt.stats && opt.bursts) {
+		fprintf(stderr, "--stats might not be used with --bursts\n");
+		return false;
+	}
+
+	if(opt.bars && (opt.stats || opt.bursts || opt.records || opt.export_dir || opt.threads || opt.depth
+	                || opt.shm_name || opt.conflate)) {
+		fprintf(stderr, "--bars might not be used with the other modes\n");
+		return false;
+	}
+
+	if(opt.replay && (opt.stats || opt.bursts || opt.bars || opt.records || opt.export_dir || opt.threads
+	                  || opt.depth || opt.shm_name || opt.conflate || opt.output || opt.async || not opt.filter.empty())) {
+		fprintf(stderr, "--replay might not be used with the other modes\n");
+		return false;
+	}
+
+	if((opt.checkpoint_every || opt.resume) && not opt.checkpoint_dir) {
+		fprintf(stderr, "--checkpoint-every and --resume-* require --checkpoint-dir\n");
+		return false;
+	}
+
+	if((opt.checkpoint_every || opt.resume) && (opt.stats || opt.bursts || opt.bars || opt.records || opt.export_dir
+	                                            || opt.replay || opt.threads || opt.reorder_window)) {
+		fprintf(stderr, "--checkpoint-every and --resume-* apply to the books without --threads and --reorder only\n");
+		return false;
+	}
+
+	if(opt.query != opt.query_security_set) {
+		fprintf(stderr, "--book-at and --security are used together\n");
+		return false;
+	}
+
+	if(opt.query && (opt.stats || opt.bursts || opt.bars || opt.records || opt.export_dir || opt.replay || opt.threads
+	                 || opt.depth || opt.shm_name || opt.conflate || opt.reorder_window || opt.checkpoint_every
+	                 || opt.resume)) {
+		fprintf(stderr, "--book-at might be used with --checkpoint-dir, --output and --async only\n");
+		return false;
+	}
+
+	if(opt.split && not opt.records) {
+		fprintf(stderr, "--split requires --format\n");
+		return false;
+	}
+
+	// The CSV tables differ in columns, a file has the rows of a single table.
+	size_t csv_tables = 0;
+	for(const simba::RecordFormat format : opt.formats) {
+		csv_tables += format == simba::RecordFormat::Csv;
+	}
+	if(csv_tables > 1u && not (opt.split && opt.split_key == simba::SplitOutput::Key::Template)) {
+		fprintf(stderr, "--format writes several CSV tables with --split=template only\n");
+		return false;
+	}
+
+	if((opt.output || opt.async) && (opt.split || opt.export_dir || opt.threads || opt.depth || opt.shm_name
+	                                 || opt.conflate)) {
+		fprintf(stderr, "--output and --async apply to the text dump, --format, --bars and --book-at only\n");
+		return false;
+	}
+
+	if(opt.direct && not (opt.async && opt.output)) {
+		fprintf(stderr, "--direct requires --async and --output\n");
+		return false;
+	}
+
+	if(opt.threads && (not opt.shm_name || opt.depth || opt.conflate)) {
+		fprintf(stderr, "--threads might be used with --shm only\n");
+		return false;
+	}
+
+	if(optind + 1 != argc) {
+		return false;
+	}
+	opt.file_name = argv[optind];
+	return true;
+}
+
+/**
+ * Open the text output selected by the options and pass it to @write.
+ * @param write - a callable 'void(output::TextBuffer&)'.
+ * @return false - in case of any errors.
+ */
+template <typename Fn>
+bool with_output(const Options& opt, Fn&& write) noexcept {
+	int fd = STDOUT_FILENO;
+	if(opt.output) {
+		fd = open(opt.output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if(fd < 0) {
+			fprintf(stderr, "'%s' : open() failed: %s\n", opt.output, strerror(errno));
+			return false;
+		}
+	}
+
+	bool result = true;
+	if(opt.async) {
+		output::AsyncWriter async(opt.async, opt.async_buffer);
+		if(async.open(fd, opt.direct)) {
+			{
+				output::TextBuffer out(async);
+				write(out);
+			}
+			result = async.close();
+			async.dump_stats(stderr);
+		} else {
+			result = false;
+		}
+	} else {
+		output::TextBuffer out(fd);
+		write(out);
+		result = out.flush();
+	}
+
+	if(opt.output) {
+		close(fd);
+	}
+	return result;
+}
+
+/**
+ * Reads all the frames and passes the UDP payloads to @process restoring the order if necessary.
+ * The other frames are reported to @errors.
+ * @param process - a callable 'void(pcap::Frame&)'.
+ */
+template <typename Fn>
+void run(pcap::Reader& reader, const Options& opt, ErrorLog& errors, Fn&& process) noexcept {
+	pcap::Frame frame;
+	std::unique_ptr<simba::ReorderBuffer> reorder;
+	if(opt.reorder_window) {
+		reorder.reset(new simba::ReorderBuffer(opt.reorder_window, opt.reorder_delay, opt.reorder_depth));
+	}
+
+	while(reader.load(frame)) {
+		if(extract_udp_payload(frame)) {
+			simba::MarketDataPacketHeader header;
+			if(reorder && SimbaParser::peek(frame, header)
+			   && header.has_flag(simba::MarketDataPacketHeader::Flags::IncrementalPacket)) {
+				reorder->push(frame, header.msg_seq_num, process);
+			} else {
+				process(frame);
+			}
+		} else {
+			errors.report(frame, ErrorLog::Reason::NotUdp);
+		}
+		errors.tick();
+	}
+
+	if(reorder) {
+		reorder->flush(process);
+		reorder->dump_stats(stderr);
+	}
+}
+
+/**
+ * Build the books up to the sending_time of the query and write the book of the security.
+ * The replay starts from the latest checkpoint at or before the time if any, it stops at the first incremental packet
+ * sent later, the later snapshot packets are skipped.
+ * @return false - in case of any errors.
+ */
+bool query_book(pcap::Reader& reader, const Options& opt, ErrorLog& errors, simba::SecurityFilter* filter) noexcept {
+	pcap::Frame frame;
+	simba::MarketDataPacketHeader header{};
+	uint64_t time = opt.query_time;
+	if(opt.query_time_of_day) {
+		// The day of the capture is the day of the first packet.
+		while(reader.load(frame)) {
+			if(extract_udp_payload(frame) && SimbaParser::peek(frame, header)) {
+				break;
+			}
+		}
+		if(header.sending_time == 0) {
+			fprintf(stderr, "'%s' : no SIMBA packets\n", opt.file_name);
+			return false;
+		}
+		constexpr uint64_t DAY = 86400ull * 1000000000ull;
+		time += header.sending_time / DAY * DAY;
+		if(not reader.seek(sizeof(pcap::pcap_hdr), 0)) {
+			return false;
+		}
+	}
+
+	BookListener listener{nullptr, nullptr, nullptr};
+	book::BookBuilder<BookListener> builder(listener, shm::TOB_LEVELS);
+	std::string path;
+	if(opt.checkpoint_dir && book::Checkpoint::find(opt.checkpoint_dir, UINT64_MAX, time, path)) {
+		book::Checkpoint checkpoint;
+		if(not checkpoint.open(path.c_str())) {
+			return false;
+		}
+		if(not checkpoint.seek(reader)) {
+			return false;
+		}
+		checkpoint.restore(builder);
+		checkpoint.dump(stderr);
+	}
+
+	while(reader.load(frame)) {
+		if(not extract_udp_payload(frame)) {
+			errors.report(frame, ErrorLog::Reason::NotUdp);
+		} else if(not SimbaParser::peek(frame, header) || header.sending_time <= time) {
+			parse_packet(frame, builder, errors, filter);
+		} else if(header.has_flag(simba::MarketDataPacketHeader::Flags::IncrementalPacket)) {
+			break;
+		}
+		errors.tick();
+	}
+	builder.dump_stats(stderr);
+
+	const book::Security* sec = builder.find(opt.query_security);
+	if(not sec) {
+		fprintf(stderr, "security_id=%d : no book at %lu\n", opt.query_security, time);
+		return false;
+	}
+	return with_output(opt, [sec, time, &opt](output::TextBuffer& out) {
+		write_book(out, *sec, time, opt.query_csv);
+	});
+}
+
 int main(int argc, char** argv) noexcept {
-	if(argc < 2) {
-		fprintf(stderr, "usage: %s [pcap-file]\n", argv[0]);
+	Options opt;
+	if(not parse_options(argc, argv, opt)) {
+		usage(stderr, argv[0]);
 		return EXIT_FAILURE;
 	}
 
-	pcap::Reader reader(argv[1]);
+	if(opt.shm_dump) {
+		shm::TopOfBookReader tob_reader;
+		if(not tob_reader.open(opt.shm_dump)) {
+			return EXIT_FAILURE;
+		}
+		tob_reader.dump(stdout);
+		return EXIT_SUCCESS;
+	}
+
+	if(opt.export_info) {
+		columnar::TableReader table;
+		if(not table.open(opt.export_info)) {
+			return EXIT_FAILURE;
+		}
+		table.dump(stdout);
+		return EXIT_SUCCESS;
+	}
+
+	ErrorLog errors(opt.error_samples, opt.error_interval * 1000u);
+	simba::SecurityFilter* filter = opt.filter.empty() ? nullptr : &opt.filter;
+	pcap::Reader reader(opt.file_name, opt.mmap);
 	if(reader.open()) {
-		pcap::Frame frame;
-		while(reader.load(frame)) {
-			if(extract_udp_payload(frame)) {
-				SimbaParser parser(frame);
-				if(not parser.dump(stdout)) {
-					frame.dump(stderr);
-					fprintf(stderr, "The frame is dropped!\n");
+		if(opt.replay) {
+			net::UdpSender sender(opt.replay_batch);
+			if(not sender.open(opt.replay, opt.multicast_if, opt.ttl)) {
+				return EXIT_FAILURE;
+			}
+			net::Pacer pacer(opt.speed, opt.replay_spin);
+			Replayer replayer(sender, pacer, opt.replay_batch);
+			run(reader, opt, errors, [&replayer](pcap::Frame& frame) {
+				replayer.send(frame);
+			});
+			const bool result = replayer.flush();
+			sender.dump_stats(stderr);
+			pacer.dump_stats(stderr);
+			if(not result) {
+				return EXIT_FAILURE;
+			}
+		} else if(opt.stats) {
+			simba::StatsHandler stats;
+			run(reader, opt, errors, [&stats, &errors, filter](pcap::Frame& frame) {
+				parse_packet(frame, stats, errors, filter);
+			});
+			stats.dump(stdout);
+			errors.dump(stdout);
+		} else if(opt.bursts) {
+			simba::BurstAnalyzer bursts(opt.burst_windows, opt.bursts, opt.burst_top);
+			run(reader, opt, errors, [&bursts, &errors, filter](pcap::Frame& frame) {
+				parse_packet(frame, bursts, errors, filter);
+			});
+			bursts.dump(stdout);
+		} else if(opt.bars) {
+			const bool result = with_output(opt, [&reader, &opt, &errors, filter](output::TextBuffer& out) {
+				simba::BarBuilder bars(out, opt.bar_intervals, opt.bars);
+				run(reader, opt, errors, [&bars, &errors, filter](pcap::Frame& frame) {
+					parse_packet(frame, bars, errors, filter);
+				});
+				bars.close();
+				bars.dump_stats(stderr);
+			});
+			if(not result) {
+				return EXIT_FAILURE;
+			}
+		} else if(opt.export_dir) {
+			columnar::Exporter exporter;
+			if(not exporter.open(opt.export_dir, opt.export_chunk, opt.export_dict)) {
+				return EXIT_FAILURE;
+			}
+			run(reader, opt, errors, [&exporter, &errors, filter](pcap::Frame& frame) {
+				parse_packet(frame, exporter, errors, filter);
+			});
+			exporter.dump_stats(stderr);
+			if(not exporter.close()) {
+				return EXIT_FAILURE;
+			}
+		} else if(opt.threads) {
+			shm::TopOfBookPublisher publisher;
+			if(not publisher.open(opt.shm_name, opt.capacity)) {
+				return EXIT_FAILURE;
+			}
+			std::vector<BookListener> listeners(opt.threads, BookListener{nullptr, &publisher, nullptr});
+
+			book::ShardedBookBuilder<BookListener> builder(listeners.data(), opt.threads, shm::TOB_LEVELS,
+			                                               opt.ring_capacity, opt.barrier_eot);
+			run(reader, opt, errors, [&builder, &errors, filter](pcap::Frame& frame) {
+				parse_packet(frame, builder, errors, filter);
+			});
+			builder.stop();
+			builder.dump_stats(stderr);
+			publisher.dump_stats(stderr);
+		} else if(opt.query) {
+			if(not query_book(reader, opt, errors, filter)) {
+				return EXIT_FAILURE;
+			}
+		} else if(opt.depth || opt.shm_name || opt.conflate || opt.checkpoint_every || opt.resume) {
+			DepthPrinter printer{stdout, uint32_t((1ull << opt.depth) - 1u)};
+			shm::TopOfBookPublisher publisher;
+			std::unique_ptr<book::Conflator> conflator;
+			BookListener listener{opt.depth ? &printer : nullptr, nullptr, nullptr};
+			if(opt.shm_name) {
+				if(not publisher.open(opt.shm_name, opt.capacity)) {
+					return EXIT_FAILURE;
 				}
-				printf("\n");
-			} else {
-				frame.dump(stderr);
-				fprintf(stderr, ": The frame is dropped, not a UDP packet\n");
+				listener.publisher = &publisher;
+			}
+
+			std::atomic<bool> done(false);
+			std::thread consumer;
+			if(opt.conflate) {
+				conflator.reset(new book::Conflator(opt.capacity));
+				listener.conflator = conflator.get();
+				consumer = std::thread([&conflator, &done, &opt]() {
+					const auto print = [](const book::TopOfBook& tob) {
+						tob.dump(stdout);
+					};
+					while(true) {
+						const bool finished = done.load(std::memory_order_acquire);
+						conflator->drain(print);
+						if(finished) {
+							break;
+						}
+						std::this_thread::sleep_for(std::chrono::microseconds(opt.conflate));
+					}
+				});
+			}
+
+			const size_t depth = opt.depth > shm::TOB_LEVELS ? opt.depth : shm::TOB_LEVELS;
+			book::BookBuilder<BookListener> builder(listener, depth);
+			book::Position position{};
+			if(opt.resume) {
+				std::string path;
+				book::Checkpoint checkpoint;
+				if(not book::Checkpoint::find(opt.checkpoint_dir, opt.resume_frame, opt.resume_time, path)) {
+					fprintf(stderr, "'%s' : no checkpoint at or before the resume point\n", opt.checkpoint_dir);
+					return EXIT_FAILURE;
+				}
+				if(not checkpoint.open(path.c_str())) {
+					return EXIT_FAILURE;
+				}
+				if(not checkpoint.seek(reader)) {
+					return EXIT_FAILURE;
+				}
+				position = checkpoint.header().position;
+				checkpoint.restore(builder);
+				checkpoint.dump(stderr);
+			}
+
+			book::Checkpointer checkpointer(opt.checkpoint_dir, opt.checkpoint_every);
+			run(reader, opt, errors, [&builder, &errors, filter, &opt, &reader, &checkpointer, &position](pcap::Frame& frame) {
+				simba::MarketDataPacketHeader header;
+				const bool checkpoint = opt.checkpoint_every && SimbaParser::peek(frame, header);
+				parse_packet(frame, builder, errors, filter);
+				if(checkpoint) {
+					if(header.has_flag(simba::MarketDataPacketHeader::Flags::IncrementalPacket)) {
+						position.msg_seq_num = header.msg_seq_num;
+					}
+					position.file_offset = reader.tell();
+					position.frame_index = reader.next_frame_index();
+					position.capture_time = frame.timestamp();
+					position.sending_time = header.sending_time;
+					checkpointer.after_packet(builder, position, reader);
+				}
+			});
+			builder.dump_stats(stderr);
+			if(opt.checkpoint_every) {
+				checkpointer.dump_stats(stderr);
+			}
+			if(opt.shm_name) {
+				publisher.dump_stats(stderr);
+			}
+			if(opt.conflate) {
+				done.store(true, std::memory_order_release);
+				consumer.join();
+				conflator->dump_stats(stderr);
+			}
+		} else if(opt.split) {
+			if(mkdir(opt.split_dir, 0755) != 0 && errno != EEXIST) {
+				fprintf(stderr, "'%s' : mkdir() failed: %s\n", opt.split_dir, strerror(errno));
+				return EXIT_FAILURE;
+			}
+			output::SplitWriter writer(opt.max_open, opt.split_chunk);
+			simba::SplitOutput split(writer, opt.split_key, opt.split_dir, opt.formats);
+			simba::RecordHandler<simba::SplitOutput> handler(split, opt.formats);
+			run(reader, opt, errors, [&handler, &errors, filter](pcap::Frame& frame) {
+				parse_packet(frame, handler, errors, filter);
+			});
+			const bool result = writer.close();
+			writer.dump_stats(stderr);
+			if(not result) {
+				return EXIT_FAILURE;
+			}
+		} else if(opt.records) {
+			const bool result = with_output(opt, [&reader, &opt, &errors, filter](output::TextBuffer& out) {
+				simba::StreamOutput stream(out);
+				simba::RecordHandler<> handler(stream, opt.formats);
+				run(reader, opt, errors, [&handler, &errors, filter](pcap::Frame& frame) {
+					parse_packet(frame, handler, errors, filter);
+				});
+			});
+			if(not result) {
+				return EXIT_FAILURE;
+			}
+		} else {
+			const bool result = with_output(opt, [&reader, &opt, &errors, filter](output::TextBuffer& out) {
+				run(reader, opt, errors, [&out, &errors, filter](pcap::Frame& frame) {
+					dump_packet(out, frame, errors, filter);
+				});
+			});
+			if(not result) {
+				return EXIT_FAILURE;
 			}
 		}
 	}
 
+	if(not opt.stats && errors.total()) {
+		errors.dump(stderr);
+	}
+	if(filter) {
+		filter->dump_stats(stderr);
+	}
+
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <time.h>
+
+#include "../concurrent/cpu.h"
+
+namespace net {
+
+/**
+ * Pacer schedules the frames at their capture time offsets divided by 'speed' from the first frame.
+ * A frame which is due later than 'spin' nanoseconds is waited for with clock_nanosleep() first,
+ * the rest is spun, so the sleep wake-up latency doesn't delay the frame.
+ * The lateness, the time the datagram is sent minus the scheduled time, is kept in a log2 histogram,
+ * it is not counted without pacing.
+ **/
+class Pacer {
+public:
+
+	static constexpr size_t BUCKETS = 65u;
+
+protected:
+
+	const double _speed;      // 0 - as fast as possible
+	const uint64_t _spin;
+	bool _started;
+	uint64_t _origin;         // the capture time of the first frame
+	uint64_t _start;          // the monotonic time of the first frame
+	uint64_t _frames;
+	uint64_t _late_sum;
+	uint64_t _late_max;
+	uint64_t _late[BUCKETS];  // the bucket N counts the lateness in [2^(N-1), 2^N) nanoseconds
+	uint64_t _sleeps;
+
+public:
+
+	/**
+	 * @param speed - the replay speed, 1 - the original timing, 0 - no pacing.
+	 * @param spin - the nanoseconds spun before a frame is due.
+	 */
+	Pacer(double speed, uint64_t spin) noexcept :
+		_speed(speed),
+		_spin(spin),
+		_started(false),
+		_origin(0),
+		_start(0),
+		_frames(0),
+		_late_sum(0),
+		_late_max(0),
+		_late(),
+		_sleeps(0) {}
+
+	static inline uint64_t now() noexcept {
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+	}
+
+	/**
+	 * @param timestamp - the capture time of a frame.
+	 * @return The monotonic time the frame is due.
+	 */
+	inline uint64_t schedule(uint64_t timestamp) noexcept {
+		if(not _started) {
+			_started = true;
+			_origin = timestamp;
+			_start = now();
+		}
+		if(_speed <= 0 || timestamp <= _origin) {
+			return _start;
+		}
+		return _start + uint64_t(double(timestamp - _origin) / _speed);
+	}
+
+	/**
+	 * Wait until @due.
+	 */
+	inline void wait(uint64_t due) noexcept {
+		uint64_t time = now();
+		if(due > time + _spin) {
+			const uint64_t wake = due - _spin;
+			const timespec ts{time_t(wake / 1000000000ull), long(wake % 1000000000ull)};
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+			_sleeps++;
+			time = now();
+		}
+		while(time < due) {
+			concurrent::cpu_relax();
+			time = now();
+		}
+	}
+
+	/**
+	 * Count a frame of @due sent at @sent.
+	 */
+	inline void record(uint64_t due, uint64_t sent) noexcept {
+		if(_speed <= 0) {
+			_frames++;
+			return;
+		}
+		const uint64_t late = sent > due ? sent - due : 0;
+		_frames++;
+		_late_sum += late;
+		_late_max = late > _late_max ? late : _late_max;
+		_late[late ? 64u - uint32_t(__builtin_clzll(late)) : 0u]++;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		const uint64_t elapsed = _started ? now() - _start : 0;
+		fprintf(out, "Pacer [ speed=%g frames=%lu sleeps=%lu elapsed=%.3fs ]\n", _speed, _frames, _sleeps,
+		        double(elapsed) / 1e9);
+		if(_speed <= 0) {
+			return;
+		}
+		fprintf(out, "  lateness ns: mean=%.0f p50<=%lu p90<=%lu p99<=%lu p99.9<=%lu max=%lu\n",
+		        _frames ? double(_late_sum) / double(_frames) : 0.0,
+		        percentile(50.0), percentile(90.0), percentile(99.0), percentile(99.9), _late_max);
+	}
+
+protected:
+
+	/**
+	 * @return The upper bound of the bucket of the percentile.
+	 */
+	uint64_t percentile(double p) const noexcept {
+		const uint64_t rank = uint64_t(double(_frames) * p / 100.0);
+		uint64_t seen = 0;
+		for(size_t idx = 0; idx < BUCKETS; ++idx) {
+			seen += _late[idx];
+			if(seen > rank) {
+				return idx < 64u ? (1ull << idx) - 1u : UINT64_MAX;
+			}
+		}
+		return 0;
+	}
+
+};
+
+}; // namespace net
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../pcap/Pcap.h"
+
+namespace net {
+
+/**
+ * UdpSender sends the datagrams to a unicast or multicast destination with sendmmsg() in batches:
+ *
+ *   sender.add(payload, size);  // copied into a slot of the batch
+ *   ...
+ *   sender.flush();             // one sendmmsg() call for the batch, the full batch is flushed by add()
+ *
+ * The multicast datagrams are looped back to the local host, so the loopback is enough for testing.
+ **/
+class UdpSender {
+public:
+
+	static constexpr size_t SLOT_SIZE = pcap::Limits::FRAME_SIZE_LIMIT;
+	static constexpr size_t MAX_BATCH = 1024u; // UIO_MAXIOV, the sendmmsg() limit
+
+protected:
+
+	int _socket;
+	sockaddr_in _destination;
+	const size_t _capacity;
+	std::unique_ptr<uint8_t[]> _buffer;  // [capacity][SLOT_SIZE]
+	std::unique_ptr<iovec[]> _iovecs;
+	std::unique_ptr<mmsghdr[]> _messages;
+	size_t _size;
+	uint64_t _datagrams;
+	uint64_t _bytes;
+	uint64_t _calls;
+
+public:
+
+	UdpSender(const UdpSender&) = delete;
+	UdpSender& operator=(const UdpSender&) = delete;
+
+	/**
+	 * @param capacity - the datagrams per sendmmsg() call.
+	 */
+	explicit UdpSender(size_t capacity) noexcept :
+		_socket(-1),
+		_destination(),
+		_capacity(capacity == 0 ? 1u : capacity < MAX_BATCH ? capacity : MAX_BATCH),
+		_buffer(new uint8_t[_capacity * SLOT_SIZE]),
+		_iovecs(new iovec[_capacity]),
+		_messages(new mmsghdr[_capacity]),
+		_size(0),
+		_datagrams(0),
+		_bytes(0),
+		_calls(0) {
+		memset(_messages.get(), 0, _capacity * sizeof(mmsghdr));
+		for(size_t idx = 0; idx < _capacity; ++idx) {
+			_iovecs[idx].iov_base = &_buffer[idx * SLOT_SIZE];
+			_messages[idx].msg_hdr.msg_iov = &_iovecs[idx];
+			_messages[idx].msg_hdr.msg_iovlen = 1u;
+			_messages[idx].msg_hdr.msg_name = &_destination;
+			_messages[idx].msg_hdr.msg_namelen = sizeof(_destination);
+		}
+	}
+
+	~UdpSender() noexcept {
+		if(_socket >= 0) {
+			::close(_socket);
+		}
+	}
+
+	inline size_t size() const noexcept {
+		return _size;
+	}
+
+	/**
+	 * Parse "ADDR:PORT", e.g. "239.0.0.1:20001".
+	 */
+	static bool parse_endpoint(const char* spec, sockaddr_in& address) noexcept {
+		const char* colon = strrchr(spec, ':');
+		if(not colon || colon - spec >= 64) {
+			return false;
+		}
+		char host[64];
+		memcpy(host, spec, size_t(colon - spec));
+		host[colon - spec] = '\0';
+		char* end;
+		const unsigned long port = strtoul(colon + 1, &end, 10);
+		memset(&address, 0, sizeof(address));
+		address.sin_family = AF_INET;
+		address.sin_port = htons(uint16_t(port));
+		return *end == '\0' && port > 0 && port <= 0xFFFFu && inet_pton(AF_INET, host, &address.sin_addr) == 1;
+	}
+
+	/**
+	 * @param destination - "ADDR:PORT".
+	 * @param interface - the address of the multicast interface, nullptr - the default one.
+	 * @param ttl - the multicast TTL.
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* destination, const char* interface, uint8_t ttl) noexcept {
+		if(not parse_endpoint(destination, _destination)) {
+			fprintf(stderr, "'%s' is not an IPv4 ADDR:PORT\n", destination);
+			return false;
+		}
+
+		_socket = socket(AF_INET, SOCK_DGRAM, 0);
+		if(_socket < 0) {
+			fprintf(stderr, "socket() failed: %s\n", strerror(errno));
+			return false;
+		}
+
+		if(IN_MULTICAST(ntohl(_destination.sin_addr.s_addr))) {
+			const unsigned char loop = 1u;
+			if(setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0
+			   || setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0) {
+				fprintf(stderr, "'%s' : setsockopt() failed: %s\n", destination, strerror(errno));
+				return false;
+			}
+			if(interface) {
+				in_addr address;
+				if(inet_pton(AF_INET, interface, &address) != 1) {
+					fprintf(stderr, "'%s' is not an IPv4 address\n", interface);
+					return false;
+				}
+				if(setsockopt(_socket, IPPROTO_IP, IP_MULTICAST_IF, &address, sizeof(address)) != 0) {
+					fprintf(stderr, "'%s' : setsockopt(IP_MULTICAST_IF) failed: %s\n", interface, strerror(errno));
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Queue a datagram, the batch is flushed when it is full.
+	 * @return false - in case of a send error.
+	 */
+	inline bool add(const void* payload, size_t size) noexcept {
+		if(_size == _capacity && not flush()) {
+			return false;
+		}
+		memcpy(_iovecs[_size].iov_base, payload, size);
+		_iovecs[_size].iov_len = size;
+		_size++;
+		return true;
+	}
+
+	/**
+	 * Send the queued datagrams.
+	 * @return false - in case of a send error, the batch is dropped.
+	 */
+	bool flush() noexcept {
+		size_t sent = 0;
+		while(sent < _size) {
+			const int result = sendmmsg(_socket, &_messages[sent], unsigned(_size - sent), 0);
+			if(result < 0) {
+				if(errno == EINTR || errno == EAGAIN || errno == ENOBUFS) {
+					continue;
+				}
+				fprintf(stderr, "sendmmsg() failed: %s\n", strerror(errno));
+				_size = 0;
+				return false;
+			}
+			for(int idx = 0; idx < result; ++idx) {
+				_bytes += _iovecs[sent + size_t(idx)].iov_len;
+			}
+			sent += size_t(result);
+			_calls++;
+		}
+		_datagrams += _size;
+		_size = 0;
+		return true;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "UdpSender [ datagrams=%lu bytes=%lu sendmmsg=%lu avg_batch=%.1f ]\n", _datagrams, _bytes,
+		        _calls, _calls ? double(_datagrams) / double(_calls) : 0.0);
+	}
+
+};
+
+}; // namespace net
@@ -0,0 +1,282 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../concurrent/Parker.h"
+#include "../concurrent/SpscRing.h"
+
+namespace output {
+
+/**
+ * AsyncWriter writes the filled buffers to a file descriptor on a dedicated thread,
+ * so the producer doesn't wait for the disk or the pipe.
+ *
+ *   producer: acquire() -> fill -> submit() -> | full ring | -> writer thread: write()
+ *                  ^                                                   |
+ *                  +-------------------- | free ring | <---------------+
+ *
+ * There are 'buffers' buffers of 'capacity' bytes, the producer waits only when all of them are full
+ * and being written (a stall). The buffers are aligned to DIRECT_ALIGNMENT.
+ *
+ * In the direct mode the descriptor is switched to O_DIRECT: the writer copies the blocks to
+ * an aligned staging buffer and writes only the whole DIRECT_ALIGNMENT pieces, the rest is carried over
+ * to the next block, the last piece is written without O_DIRECT by close().
+ *
+ * The idle writer thread and the stalled producer sleep on a concurrent::Parker after a short spin.
+ *
+ * The single producer thread is the one which calls open(), acquire(), submit() and close().
+ **/
+class AsyncWriter {
+public:
+
+	static constexpr size_t DIRECT_ALIGNMENT = 4096u;
+
+protected:
+
+	struct Block {
+		uint32_t idx;  // STOP - the writer exits
+		uint32_t size;
+	};
+
+	static constexpr uint32_t STOP = UINT32_MAX;
+
+	int _fd;
+	const size_t _capacity;
+	const uint32_t _buffers;
+	char* _memory;
+	char* _staging;    // the direct mode only, capacity + DIRECT_ALIGNMENT bytes
+	size_t _carry;     // bytes at the staging head to be written with the next block
+	bool _fallback;    // the writer thread has disabled O_DIRECT
+	concurrent::SpscRing<Block> _full;
+	concurrent::SpscRing<uint32_t> _free;
+	concurrent::Parker _full_event; // a block is pushed into '_full'
+	concurrent::Parker _free_event; // a buffer is pushed into '_free'
+	std::thread _thread;
+	std::atomic<bool> _failed;
+	bool _direct;
+	bool _running;
+	uint64_t _blocks;  // producer side
+	uint64_t _bytes;
+	uint64_t _stalls;
+
+public:
+
+	AsyncWriter(const AsyncWriter&) = delete;
+	AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+	/**
+	 * @param buffers - the number of buffers, at least 2.
+	 * @param capacity - the buffer size, rounded up to DIRECT_ALIGNMENT.
+	 */
+	AsyncWriter(uint32_t buffers, size_t capacity) noexcept :
+		_fd(-1),
+		_capacity((capacity + DIRECT_ALIGNMENT - 1u) & ~(DIRECT_ALIGNMENT - 1u)),
+		_buffers(buffers < 2u ? 2u : buffers),
+		_memory(nullptr),
+		_staging(nullptr),
+		_carry(0),
+		_fallback(false),
+		_full(_buffers),
+		_free(_buffers),
+		_full_event(),
+		_free_event(),
+		_thread(),
+		_failed(false),
+		_direct(false),
+		_running(false),
+		_blocks(0),
+		_bytes(0),
+		_stalls(0) {}
+
+	~AsyncWriter() noexcept {
+		close();
+		free(_staging);
+		free(_memory);
+	}
+
+	/**
+	 * Allocate the buffers and start the writer thread.
+	 * @param fd - a file descriptor to write to, it is not closed.
+	 * @param direct - try to write with O_DIRECT, a regular file is required.
+	 * @return false - the buffers are not allocated.
+	 */
+	bool open(int fd, bool direct) noexcept {
+		_memory = static_cast<char*>(aligned_alloc(DIRECT_ALIGNMENT, _capacity * _buffers));
+		if(not _memory) {
+			fprintf(stderr, "aligned_alloc() failed: %u buffers of %zu bytes\n", _buffers, _capacity);
+			return false;
+		}
+		_fd = fd;
+		for(uint32_t idx = 0; idx < _buffers; ++idx) {
+			_free.push(idx);
+		}
+		if(direct) {
+			enable_direct();
+		}
+		_running = true;
+		_thread = std::thread([this]() {
+			work();
+		});
+		return true;
+	}
+
+	inline size_t capacity() const noexcept {
+		return _capacity;
+	}
+
+	inline bool direct() const noexcept {
+		return _direct;
+	}
+
+	/**
+	 * @return An empty buffer of capacity() bytes, waits if all the buffers are being written.
+	 */
+	char* acquire() noexcept {
+		uint32_t idx;
+		if(not _free.try_pop(idx)) {
+			_stalls++;
+			while(not _free.try_pop(idx)) {
+				_free_event.await([this]() {
+					return not _free.empty();
+				});
+			}
+		}
+		return _memory + size_t(idx) * _capacity;
+	}
+
+	/**
+	 * Pass @size bytes of @buffer to the writer thread, the buffer MUST NOT be used after the call.
+	 */
+	void submit(char* buffer, size_t size) noexcept {
+		const uint32_t idx = uint32_t(size_t(buffer - _memory) / _capacity);
+		_full.push(Block{idx, uint32_t(size)});
+		_full_event.notify();
+		_blocks++;
+		_bytes += size;
+	}
+
+	/**
+	 * Return an acquired buffer without writing it.
+	 */
+	void release(char* buffer) noexcept {
+		const uint32_t idx = uint32_t(size_t(buffer - _memory) / _capacity);
+		_full.push(Block{idx, 0});
+		_full_event.notify();
+	}
+
+	/**
+	 * Write all the submitted buffers and stop the writer thread.
+	 * @return false - if any write error has happened.
+	 */
+	bool close() noexcept {
+		if(_running) {
+			_full.push(Block{STOP, 0});
+			_full_event.notify();
+			_thread.join();
+			_running = false;
+			if(_carry) {
+				disable_direct();
+				write(_staging, _carry);
+				_carry = 0;
+			}
+		}
+		return not _failed.load(std::memory_order_relaxed);
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "AsyncWriter [ buffers=%u capacity=%zu direct=%d blocks=%lu bytes=%lu stalls=%lu ]\n",
+		        _buffers, _capacity, int(_direct), _blocks, _bytes, _stalls);
+	}
+
+protected:
+
+	void enable_direct() noexcept {
+		const int flags = fcntl(_fd, F_GETFL);
+		if(flags < 0 || fcntl(_fd, F_SETFL, flags | O_DIRECT) != 0) {
+			fprintf(stderr, "O_DIRECT is not supported, the buffered writes are used: %s\n", strerror(errno));
+			return;
+		}
+		_staging = static_cast<char*>(aligned_alloc(DIRECT_ALIGNMENT, _capacity + DIRECT_ALIGNMENT));
+		if(not _staging) {
+			fprintf(stderr, "aligned_alloc() failed, the buffered writes are used\n");
+			disable_direct();
+			return;
+		}
+		_direct = true;
+	}
+
+	void disable_direct() noexcept {
+		const int flags = fcntl(_fd, F_GETFL);
+		if(flags >= 0) {
+			fcntl(_fd, F_SETFL, flags & ~O_DIRECT);
+		}
+	}
+
+	void work() noexcept {
+		Block block;
+		while(true) {
+			if(not _full.try_pop(block)) {
+				_full_event.await([this]() {
+					return not _full.empty();
+				});
+				continue;
+			}
+
+			if(block.idx == STOP) {
+				return;
+			}
+
+			const char* data = _memory + size_t(block.idx) * _capacity;
+			if(_direct) {
+				write_direct(data, block.size);
+			} else {
+				write(data, block.size);
+			}
+			_free.push(block.idx);
+			_free_event.notify();
+		}
+	}
+
+	void write_direct(const char* data, size_t size) noexcept {
+		memcpy(_staging + _carry, data, size);
+		const size_t total = _carry + size;
+		const size_t aligned = total & ~(DIRECT_ALIGNMENT - 1u);
+		write(_staging, aligned);
+		_carry = total - aligned;
+		memmove(_staging, _staging + aligned, _carry);
+	}
+
+	void write(const char* data, size_t size) noexcept {
+		while(size > 0 && not _failed.load(std::memory_order_relaxed)) {
+			const ssize_t written = ::write(_fd, data, size);
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				if(errno == EINVAL && _staging && not _fallback) {
+					// The file system has accepted O_DIRECT but doesn't support it, the staging keeps the writes aligned.
+					fprintf(stderr, "O_DIRECT write() failed, the buffered writes are used\n");
+					disable_direct();
+					_fallback = true;
+					continue;
+				}
+				fprintf(stderr, "write() failed: %s\n", strerror(errno));
+				_failed.store(true, std::memory_order_relaxed);
+				break;
+			}
+			data += written;
+			size -= size_t(written);
+		}
+	}
+
+};
+
+}; // namespace output
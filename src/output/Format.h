@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+
+namespace output {
+
+/**
+ * Allocation free number conversions.
+ * Every function writes to @ptr, which MUST have at least FORMAT_MAX free bytes,
+ * and returns the pointer past the last written character. No terminating zero is written.
+ **/
+
+// The longest conversion: "-" + 20 digits of uint64_t + "." + 19 digits of the fraction.
+static constexpr size_t FORMAT_MAX = 48u;
+
+/**
+ * @return The number of decimal digits of @value.
+ */
+inline constexpr unsigned count_digits(uint64_t value) noexcept {
+	unsigned result = 1u;
+	while(value >= 10u) {
+		value /= 10u;
+		++result;
+	}
+	return result;
+}
+
+/**
+ * @return The number of the fraction digits of a fixed-point value with @divisor, which is a power of ten.
+ */
+inline constexpr unsigned fraction_digits(uint64_t divisor) noexcept {
+	return count_digits(divisor) - 1u;
+}
+
+/**
+ * Write @value padded with zeros to @width digits.
+ */
+inline char* format_uint(char* ptr, uint64_t value, unsigned width = 0) noexcept {
+	static const char pairs[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	unsigned length = count_digits(value);
+	if(length < width) {
+		length = width;
+	}
+
+	char* end = ptr + length;
+	char* cur = end;
+	while(value >= 100u) {
+		const unsigned idx = unsigned(value % 100u) * 2u;
+		value /= 100u;
+		*--cur = pairs[idx + 1u];
+		*--cur = pairs[idx];
+	}
+	if(value >= 10u) {
+		const unsigned idx = unsigned(value) * 2u;
+		*--cur = pairs[idx + 1u];
+		*--cur = pairs[idx];
+	} else {
+		*--cur = char('0' + value);
+	}
+	while(cur > ptr) {
+		*--cur = '0';
+	}
+	return end;
+}
+
+inline char* format_int(char* ptr, int64_t value) noexcept {
+	if(value < 0) {
+		*ptr++ = '-';
+		return format_uint(ptr, 0u - uint64_t(value));
+	}
+	return format_uint(ptr, uint64_t(value));
+}
+
+/**
+ * Write @value in lower case hex digits without a prefix.
+ */
+inline char* format_hex(char* ptr, uint64_t value) noexcept {
+	static const char digits[] = "0123456789abcdef";
+	const unsigned length = value ? (67u - unsigned(__builtin_clzll(value))) / 4u : 1u;
+	for(unsigned i = length; i > 0; --i) {
+		ptr[i - 1u] = digits[value & 0xFu];
+		value >>= 4u;
+	}
+	return ptr + length;
+}
+
+/**
+ * Write the exact decimal representation of the fixed-point value 'mantissa / divisor'.
+ * @param divisor - a power of ten.
+ */
+inline char* format_decimal(char* ptr, int64_t mantissa, uint64_t divisor) noexcept {
+	const uint64_t abs = mantissa < 0 ? 0u - uint64_t(mantissa) : uint64_t(mantissa);
+	const unsigned digits = fraction_digits(divisor);
+
+	if(mantissa < 0) {
+		*ptr++ = '-';
+	}
+	ptr = format_uint(ptr, abs / divisor);
+	if(digits > 0) {
+		*ptr++ = '.';
+		ptr = format_uint(ptr, abs % divisor, digits);
+	}
+	return ptr;
+}
+
+}; // namespace output
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "TextBuffer.h"
+
+namespace output {
+
+/**
+ * SplitWriter writes many files, e.g. one per security, through a bounded number of open descriptors.
+ *
+ * Every file has its own TextBuffer, the text is appended to buffer() and commit() writes the buffer out
+ * with a single write() when it holds at least 'chunk' bytes. The descriptors are kept in the LRU order,
+ * the least recently written file is closed when 'max_open' descriptors are open, it is reopened
+ * for appending on the next write.
+ *
+ * The buffers are not attached to the descriptors, so a file MUST NOT get more than ROW_MAX bytes
+ * between two commit() calls. A failure is sticky per file: once a file has failed to open or to be written,
+ * its text is dropped and it is not reopened, close() reports the incomplete files.
+ **/
+class SplitWriter {
+public:
+
+	static constexpr uint32_t NONE = UINT32_MAX;
+	static constexpr size_t ROW_MAX = 16u << 10u;
+
+protected:
+
+	struct File {
+		std::string path;
+		std::unique_ptr<TextBuffer> buffer;
+		int fd;
+		bool created;  // the file has been truncated
+		bool failed;   // open() or write() has failed, the file is incomplete
+		uint32_t tags; // the user bits
+		uint32_t prev; // the LRU list of the open files, the head is the most recent
+		uint32_t next;
+	};
+
+	std::vector<File> _files;
+	const size_t _chunk;
+	const size_t _max_open;
+	size_t _open;
+	uint32_t _head;
+	uint32_t _tail;
+	uint64_t _opens;
+	uint64_t _evictions;
+	uint64_t _writes;
+	uint64_t _bytes;
+	uint64_t _failed;  // the failed files
+	bool _closed;
+
+public:
+
+	SplitWriter(const SplitWriter&) = delete;
+	SplitWriter& operator=(const SplitWriter&) = delete;
+
+	/**
+	 * @param max_open - the maximum number of open descriptors.
+	 * @param chunk - the minimum number of bytes written at once.
+	 */
+	SplitWriter(size_t max_open, size_t chunk) noexcept :
+		_files(),
+		_chunk(chunk),
+		_max_open(max_open ? max_open : 1u),
+		_open(0),
+		_head(NONE),
+		_tail(NONE),
+		_opens(0),
+		_evictions(0),
+		_writes(0),
+		_bytes(0),
+		_failed(0),
+		_closed(false) {}
+
+	~SplitWriter() noexcept {
+		close();
+	}
+
+	/**
+	 * Register a file, it is created on the first write.
+	 * @return The file index.
+	 */
+	uint32_t add(std::string path) noexcept {
+		_files.push_back(File{std::move(path), std::unique_ptr<TextBuffer>(new TextBuffer(-1, _chunk + ROW_MAX)),
+		                      -1, false, false, 0, NONE, NONE});
+		return uint32_t(_files.size() - 1u);
+	}
+
+	inline size_t files() const noexcept {
+		return _files.size();
+	}
+
+	inline TextBuffer& buffer(uint32_t idx) noexcept {
+		return *_files[idx].buffer;
+	}
+
+	inline uint32_t& tags(uint32_t idx) noexcept {
+		return _files[idx].tags;
+	}
+
+	/**
+	 * Write the buffer of the file out if it is large enough.
+	 */
+	inline void commit(uint32_t idx) noexcept {
+		if(_files[idx].buffer->size() >= _chunk) {
+			flush(idx);
+		}
+	}
+
+	/**
+	 * Write the buffer of the file out.
+	 * @return false - the file has failed, the buffered text is dropped.
+	 */
+	bool flush(uint32_t idx) noexcept {
+		File& file = _files[idx];
+		TextBuffer& buffer = *file.buffer;
+		if(file.failed) {
+			buffer.clear();
+			return false;
+		}
+		if(buffer.size() == 0) {
+			return true;
+		}
+
+		bool result = acquire(idx);
+		const char* ptr = buffer.data();
+		size_t left = buffer.size();
+		while(result && left > 0) {
+			const ssize_t written = ::write(file.fd, ptr, left);
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				fprintf(stderr, "'%s' : write() failed: %s\n", file.path.c_str(), strerror(errno));
+				result = false;
+				break;
+			}
+			ptr += written;
+			left -= size_t(written);
+		}
+		_writes++;
+		_bytes += buffer.size() - left;
+		buffer.clear();
+		if(not result) {
+			fail(idx);
+			if(file.fd >= 0) {
+				release(idx);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * Write all the buffers out and close the files.
+	 * @return false - if any file has failed, the failed files are listed.
+	 */
+	bool close() noexcept {
+		if(_closed) {
+			return _failed == 0;
+		}
+		for(uint32_t idx = 0; idx < _files.size(); ++idx) {
+			flush(idx);
+		}
+		while(_tail != NONE) {
+			release(_tail);
+		}
+		for(const File& file : _files) {
+			if(file.failed) {
+				fprintf(stderr, "'%s' : the file is incomplete\n", file.path.c_str());
+			}
+		}
+		_closed = true;
+		return _failed == 0;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "SplitWriter [ files=%zu max_open=%zu opens=%lu evictions=%lu writes=%lu bytes=%lu failed=%lu ]\n",
+		        _files.size(), _max_open, _opens, _evictions, _writes, _bytes, _failed);
+	}
+
+protected:
+
+	/**
+	 * Open the file if necessary and make it the most recent one.
+	 */
+	bool acquire(uint32_t idx) noexcept {
+		File& file = _files[idx];
+		if(file.fd >= 0) {
+			if(_head != idx) {
+				unlink(idx);
+				link_head(idx);
+			}
+			return true;
+		}
+
+		if(_open == _max_open) {
+			release(_tail);
+			_evictions++;
+		}
+
+		const int flags = O_WRONLY | O_CREAT | (file.created ? O_APPEND : O_TRUNC);
+		file.fd = ::open(file.path.c_str(), flags, 0644);
+		if(file.fd < 0) {
+			fprintf(stderr, "'%s' : open() failed: %s\n", file.path.c_str(), strerror(errno));
+			return false;
+		}
+		file.created = true;
+		_opens++;
+		_open++;
+		link_head(idx);
+		return true;
+	}
+
+	void release(uint32_t idx) noexcept {
+		File& file = _files[idx];
+		unlink(idx);
+		if(::close(file.fd) != 0 && not file.failed) {
+			fprintf(stderr, "'%s' : close() failed: %s\n", file.path.c_str(), strerror(errno));
+			fail(idx);
+		}
+		file.fd = -1;
+		_open--;
+	}
+
+	/**
+	 * Mark the file as failed, it is not opened or written anymore.
+	 */
+	inline void fail(uint32_t idx) noexcept {
+		File& file = _files[idx];
+		if(not file.failed) {
+			file.failed = true;
+			_failed++;
+		}
+	}
+
+	void link_head(uint32_t idx) noexcept {
+		File& file = _files[idx];
+		file.prev = NONE;
+		file.next = _head;
+		if(_head != NONE) {
+			_files[_head].prev = idx;
+		} else {
+			_tail = idx;
+		}
+		_head = idx;
+	}
+
+	void unlink(uint32_t idx) noexcept {
+		File& file = _files[idx];
+		if(file.prev != NONE) {
+			_files[file.prev].next = file.next;
+		} else {
+			_head = file.next;
+		}
+		if(file.next != NONE) {
+			_files[file.next].prev = file.prev;
+		} else {
+			_tail = file.prev;
+		}
+		file.prev = NONE;
+		file.next = NONE;
+	}
+
+};
+
+}; // namespace output
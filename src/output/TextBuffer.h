@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <unistd.h>
+
+#include "Format.h"
+#include "AsyncWriter.h"
+
+namespace output {
+
+/**
+ * TextBuffer accumulates text in a large contiguous buffer and writes it to a file descriptor
+ * with a single 'write()' call when the buffer is full or flush() is called.
+ *
+ * The number conversions are hand-rolled and produce exactly the same text as the corresponding
+ * printf() conversions: append_uint() - "%lu", append_int() - "%ld", append_hex() - "%lx",
+ * append_fixed() - "%f" of a fixed-point value.
+ * append_decimal() writes the exact text of a fixed-point value, it is not rounded to 6 digits as "%f".
+ * append_value() writes any value which provides 'char* to_chars(char*) const', e.g. simba::IntNull.
+ *
+ * A TextBuffer attached to an AsyncWriter hands the filled buffer over to the writer thread
+ * and continues with an empty one, nothing is copied.
+ **/
+class TextBuffer {
+
+	static constexpr size_t NUMBER_MAX = FORMAT_MAX;
+
+protected:
+	std::unique_ptr<char[]> _storage;
+	AsyncWriter* _async;
+	char* _buffer;
+	const size_t _capacity;
+	size_t _size;
+	int _fd;
+
+public:
+
+	static constexpr size_t DEFAULT_CAPACITY = 1u << 20u;
+
+	TextBuffer(const TextBuffer&) = delete;
+	TextBuffer& operator=(const TextBuffer&) = delete;
+
+	/**
+	 * @param fd - a file descriptor to write to.
+	 * @param capacity - the buffer size in bytes.
+	 */
+	explicit TextBuffer(int fd, size_t capacity = DEFAULT_CAPACITY) noexcept :
+		_storage(new char[capacity < NUMBER_MAX * 2u ? NUMBER_MAX * 2u : capacity]),
+		_async(nullptr),
+		_buffer(_storage.get()),
+		_capacity(capacity < NUMBER_MAX * 2u ? NUMBER_MAX * 2u : capacity),
+		_size(0),
+		_fd(fd) {}
+
+	/**
+	 * @param async - the writer to pass the filled buffers to, the buffers are of its capacity.
+	 *   The TextBuffer MUST be destroyed before AsyncWriter::close().
+	 */
+	explicit TextBuffer(AsyncWriter& async) noexcept :
+		_storage(),
+		_async(&async),
+		_buffer(async.acquire()),
+		_capacity(async.capacity()),
+		_size(0),
+		_fd(-1) {}
+
+	~TextBuffer() noexcept {
+		flush();
+		if(_async) {
+			_async->release(_buffer);
+		}
+	}
+
+	inline size_t size() const noexcept {
+		return _size;
+	}
+
+	inline const char* data() const noexcept {
+		return _buffer;
+	}
+
+	/**
+	 * Write the buffered text out.
+	 * @return false - in case of a write error, the text is dropped.
+	 *   The errors of an AsyncWriter are reported by AsyncWriter::close().
+	 */
+	bool flush() noexcept {
+		if(_async) {
+			if(_size) {
+				_async->submit(_buffer, _size);
+				_buffer = _async->acquire();
+				_size = 0;
+			}
+			return true;
+		}
+
+		bool result = true;
+		const char* ptr = _buffer;
+		size_t left = _size;
+		while(left > 0) {
+			const ssize_t written = ::write(_fd, ptr, left);
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				result = false;
+				break;
+			}
+			ptr += written;
+			left -= size_t(written);
+		}
+		_size = 0;
+		return result;
+	}
+
+	/**
+	 * Drop the buffered text.
+	 */
+	inline void clear() noexcept {
+		_size = 0;
+	}
+
+	inline TextBuffer& append(const char* str, size_t length) noexcept {
+		if(length > _capacity - _size) {
+			flush();
+			if(length > _capacity) {
+				write_through(str, length);
+				return *this;
+			}
+		}
+		memcpy(_buffer + _size, str, length);
+		_size += length;
+		return *this;
+	}
+
+	/**
+	 * Append a string literal, the length is known at compile time.
+	 */
+	template <size_t N>
+	inline TextBuffer& append(const char (&literal)[N]) noexcept {
+		return append(literal, N - 1u);
+	}
+
+	inline TextBuffer& append_str(const char* str) noexcept {
+		return append(str, strlen(str));
+	}
+
+	inline TextBuffer& append_char(char c) noexcept {
+		if(_size == _capacity) {
+			flush();
+		}
+		_buffer[_size++] = c;
+		return *this;
+	}
+
+	inline TextBuffer& append_uint(uint64_t value) noexcept {
+		_size = format_uint(reserve(), value) - _buffer;
+		return *this;
+	}
+
+	inline TextBuffer& append_int(int64_t value) noexcept {
+		_size = format_int(reserve(), value) - _buffer;
+		return *this;
+	}
+
+	inline TextBuffer& append_hex(uint64_t value) noexcept {
+		_size = format_hex(reserve(), value) - _buffer;
+		return *this;
+	}
+
+	/**
+	 * Append the exact decimal text of a fixed-point value 'mantissa / divisor', see format_decimal().
+	 */
+	inline TextBuffer& append_decimal(int64_t mantissa, uint64_t divisor) noexcept {
+		_size = format_decimal(reserve(), mantissa, divisor) - _buffer;
+		return *this;
+	}
+
+	/**
+	 * Append a value which writes itself with 'char* to_chars(char* ptr) const', at most NUMBER_MAX bytes.
+	 */
+	template <typename V>
+	inline TextBuffer& append_value(const V& value) noexcept {
+		_size = value.to_chars(reserve()) - _buffer;
+		return *this;
+	}
+
+	/**
+	 * Append a fixed-point value 'mantissa / divisor' the same way as printf("%f", double(mantissa) / divisor).
+	 * The conversion is exact for the values whose double representation is precise enough,
+	 * printf() is used for the rest.
+	 * @param divisor - a power of ten, not greater than 1000000.
+	 */
+	inline TextBuffer& append_fixed(int64_t mantissa, int64_t divisor) noexcept {
+		char* ptr = reserve();
+		const uint64_t abs = mantissa < 0 ? 0u - uint64_t(mantissa) : uint64_t(mantissa);
+		if(abs >= uint64_t(divisor) << 32u) {
+			const int length = snprintf(ptr, NUMBER_MAX, "%f", double(mantissa) / divisor);
+			_size += size_t(length);
+			return *this;
+		}
+
+		if(mantissa < 0) {
+			*ptr++ = '-';
+		}
+		ptr = format_uint(ptr, abs / uint64_t(divisor));
+		*ptr++ = '.';
+		uint64_t fraction = (abs % uint64_t(divisor)) * uint64_t(1000000 / divisor);
+		for(size_t i = 6u; i > 0; --i) {
+			ptr[i - 1u] = char('0' + fraction % 10u);
+			fraction /= 10u;
+		}
+		_size = ptr + 6u - _buffer;
+		return *this;
+	}
+
+protected:
+
+	/**
+	 * @return A pointer to at least NUMBER_MAX free bytes.
+	 */
+	inline char* reserve() noexcept {
+		if(_capacity - _size < NUMBER_MAX) {
+			flush();
+		}
+		return _buffer + _size;
+	}
+
+	void write_through(const char* str, size_t length) noexcept {
+		if(_async) {
+			while(length > 0) {
+				const size_t piece = length < _capacity ? length : _capacity;
+				memcpy(_buffer, str, piece);
+				_size = piece;
+				flush();
+				str += piece;
+				length -= piece;
+			}
+			return;
+		}
+
+		while(length > 0) {
+			const ssize_t written = ::write(_fd, str, length);
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				break;
+			}
+			str += written;
+			length -= size_t(written);
+		}
+	}
+
+};
+
+}; // namespace output
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <cstdio>
 
 namespace pcap {
@@ -64,6 +65,15 @@ public:
 		return (fseek(_file, size, SEEK_CUR) == 0);
 	}
 
+	inline uint64_t tell() noexcept {
+		const off_t offset = ftello(_file);
+		return offset < 0 ? 0 : uint64_t(offset);
+	}
+
+	inline bool seek(uint64_t offset) noexcept {
+		return fseeko(_file, off_t(offset), SEEK_SET) == 0;
+	}
+
 private:
 
 	inline void clear() noexcept {
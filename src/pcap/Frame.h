@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <cstdio>
+#include <cstring>
 #include "Pcap.h"
 
 namespace pcap {
@@ -39,6 +40,7 @@ protected:
 	size_t _available; // bytes available to read
 	size_t _padding;   // padding bytes
 	uint64_t _index;   // The frame index in the PCAP dump file.
+	uint64_t _ts;      // The capture timestamp in nanoseconds.
 
 public:
 
@@ -52,7 +54,9 @@ public:
 		_begin(new PtrBase_t[Limits::FRAME_SIZE_LIMIT])
 		, _offset(0)
 		, _available(0)
-		, _padding(0) {}
+		, _padding(0)
+		, _index(0)
+		, _ts(0) {}
 
 	/**
 	 * @return The 'begin' pointer.
@@ -117,6 +121,20 @@ public:
 		return bytes <= _available;
 	}
 
+	/**
+	 * @return The frame index in the PCAP dump file.
+	 */
+	inline uint64_t index() const noexcept {
+		return _index;
+	}
+
+	/**
+	 * @return The capture timestamp in nanoseconds since the epoch.
+	 */
+	inline uint64_t timestamp() const noexcept {
+		return _ts;
+	}
+
 	/**
 	 * @return The size of the internal buffer.
 	 */
@@ -128,14 +146,29 @@ public:
 	 * Reset the state of the packet.
 	 * @return true - if the packet has enough stace in the memory area to perform the operation.
 	 */
-	inline bool reset(size_t available, uint64_t index) noexcept {
+	inline bool reset(size_t available, uint64_t index, uint64_t ts = 0) noexcept {
 		_offset = 0;
 		_available = available;
 		_padding = 0;
 		_index = index;
+		_ts = ts;
 		return available < capacity();
 	}
 
+	/**
+	 * Copy the content and the state of @other frame.
+	 * Only the 'begin'..'end' area of @other is copied.
+	 * @param other - a frame to copy from.
+	 */
+	inline void copy(const Frame& other) noexcept {
+		memcpy(begin(), other.begin(), other.size());
+		_offset = other._offset;
+		_available = other._available;
+		_padding = other._padding;
+		_index = other._index;
+		_ts = other._ts;
+	}
+
 	/**
 	 * Move the head @bytes forward.
 	 * @param bytes - bytes to move.
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace pcap {
+
+/**
+ * MappedFile reads a file mapped into memory with the same interface as CFile,
+ * so the data is copied straight from the page cache without the stdio buffering.
+ */
+class MappedFile {
+
+	const uint8_t* _data;
+	size_t _size;
+	size_t _position;
+
+public:
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile() noexcept : _data(nullptr), _size(0), _position(0) {}
+
+	~MappedFile() noexcept {
+		close();
+	}
+
+	/**
+	 * @return false - the file is not available or empty.
+	 */
+	bool open(const char* file_name) noexcept {
+		close();
+		const int fd = ::open(file_name, O_RDONLY);
+		if(fd < 0) {
+			return false;
+		}
+
+		const off_t size = lseek(fd, 0, SEEK_END);
+		void* addr = size > 0 ? mmap(nullptr, size_t(size), PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+		::close(fd);
+		if(addr == MAP_FAILED) {
+			return false;
+		}
+
+		madvise(addr, size_t(size), MADV_SEQUENTIAL);
+		_data = static_cast<const uint8_t*>(addr);
+		_size = size_t(size);
+		_position = 0;
+		return true;
+	}
+
+	inline void close() noexcept {
+		if(_data) {
+			munmap(const_cast<uint8_t*>(_data), _size);
+			_data = nullptr;
+			_size = 0;
+			_position = 0;
+		}
+	}
+
+	template <typename T>
+	inline bool read_pod(T& pod) noexcept {
+		return read_bytes(&pod, sizeof(pod));
+	}
+
+	template <typename T>
+	inline bool read_bytes(T* buffer, size_t size) noexcept {
+		if(size > _size - _position) {
+			_position = _size;
+			return false;
+		}
+		memcpy(buffer, _data + _position, size);
+		_position += size;
+		return true;
+	}
+
+	inline bool skip_bytes(size_t size) noexcept {
+		if(size > _size - _position) {
+			return false;
+		}
+		_position += size;
+		return true;
+	}
+
+	inline uint64_t tell() const noexcept {
+		return _position;
+	}
+
+	inline bool seek(uint64_t offset) noexcept {
+		if(offset > _size) {
+			return false;
+		}
+		_position = size_t(offset);
+		return true;
+	}
+
+	inline const uint8_t* data() const noexcept {
+		return _data;
+	}
+
+	inline size_t size() const noexcept {
+		return _size;
+	}
+
+};
+
+}; // namespace pcap;
@@ -5,10 +5,13 @@
 #include <cstring>
 #include <cstdlib>
 #include <string>
+#include <sys/stat.h>
 
 #include "Pcap.h"
 #include "CFile.h"
+#include "MappedFile.h"
 #include "Frame.h"
+#include "../Profile.h"
 
 namespace pcap {
 
@@ -18,8 +21,11 @@ protected:
 
 	const std::string _file_name;
 	CFile _file;
+	MappedFile _map;
+	const bool _mapped;
 	bool _fields_swap;
 	pcap_hdr _pcap_header;
+	uint64_t _file_size;
 	size_t _next_frame_index;
 
 public:
@@ -32,11 +38,16 @@ public:
 
 	/**
 	 * @param file_name - PCAP file path. MUST NOT be empty.
+	 * @param mapped - read the file mapped into memory instead of the stdio stream.
 	 */
-	Reader(std::string file_name) noexcept :
+	Reader(std::string file_name, bool mapped = false) noexcept :
 		_file_name(std::move(file_name)),
 		_file(),
+		_map(),
+		_mapped(mapped),
 		_fields_swap(false),
+		_pcap_header(),
+		_file_size(0),
 		_next_frame_index(0) {}
 
 
@@ -53,13 +64,13 @@ public:
 	 */
 	bool open() noexcept {
 
-		auto file = CFile(fopen(_file_name.c_str(), "rb"));
-		if(file.get() == nullptr) {
+		auto file = CFile(_mapped ? nullptr : fopen(_file_name.c_str(), "rb"));
+		if(_mapped ? not _map.open(_file_name.c_str()) : file.get() == nullptr) {
 			fprintf(stderr, "'%s' is not available for reading.\n", _file_name.c_str());
 			return false;
 		}
 
-		if(not file.read_pod(_pcap_header)) {
+		if(not (_mapped ? _map.read_pod(_pcap_header) : file.read_pod(_pcap_header))) {
 			fprintf(stderr, "'%s' is not a PCAP file.\n", _file_name.c_str());
 			return false;
 		}
@@ -94,6 +105,8 @@ public:
 			return false;
 		}
 
+		struct stat st;
+		_file_size = _mapped ? _map.size() : fstat(fileno(file.get()), &st) == 0 ? uint64_t(st.st_size) : 0;
 		_file = std::move(file);
 
 		return true;
@@ -105,16 +118,18 @@ public:
 	 * @return false - in case of nothing to read or the frame size is exceeded.
 	 */
 	inline bool load(Frame& frame) noexcept {
+		SIMBA_PROFILE_SPAN(Io);
 		bool result = false;
 		pcaprec_hdr record;
-		if(_file.read_pod(record)) {
+		if(read_bytes(&record, sizeof(record))) {
 
 			if(_fields_swap) {
 				record_bytes_swap(record);
 			}
 
-			if(frame.reset(record.incl_len, _next_frame_index)) {
-				result = _file.read_bytes(frame.begin(), frame.available());
+			const uint64_t ts = uint64_t(record.ts_sec) * 1000000000ull + uint64_t(record.ts_usec) * 1000ull;
+			if(frame.reset(record.incl_len, _next_frame_index, ts)) {
+				result = read_bytes(frame.begin(), frame.available());
 			} else {
 				fprintf(stderr, "the frame size is exceeded.");
 			}
@@ -131,6 +146,50 @@ public:
 		return _next_frame_index;
 	}
 
+	/**
+	 * @return The file offset of the frame that will be read with 'load()' next.
+	 */
+	inline uint64_t tell() noexcept {
+		return _mapped ? _map.tell() : _file.tell();
+	}
+
+	/**
+	 * Read the record header of the frame that will be read with 'load()' next, the position is kept.
+	 * @param record - the header as it is stored in the file.
+	 * @return false - in case of nothing to read.
+	 */
+	bool peek_record(pcaprec_hdr& record) noexcept {
+		const uint64_t offset = tell();
+		const bool result = read_bytes(&record, sizeof(record));
+		if(_mapped ? not _map.seek(offset) : not _file.seek(offset)) {
+			return false;
+		}
+		return result;
+	}
+
+	inline const pcap_hdr& pcap_header() const noexcept {
+		return _pcap_header;
+	}
+
+	inline uint64_t file_size() const noexcept {
+		return _file_size;
+	}
+
+	/**
+	 * Move to a frame, e.g. the one saved by a checkpoint.
+	 * @param offset - the file offset of the frame returned by 'tell()'.
+	 * @param frame_index - the index of the frame.
+	 * @return false - in case of the offset is out of the file.
+	 */
+	bool seek(uint64_t offset, size_t frame_index) noexcept {
+		if(offset < sizeof(pcap_hdr) || not (_mapped ? _map.seek(offset) : _file.seek(offset))) {
+			fprintf(stderr, "'%s' : failed to seek to the offset %lu.\n", _file_name.c_str(), offset);
+			return false;
+		}
+		_next_frame_index = frame_index;
+		return true;
+	}
+
 	/**
 	 * For debug purposes.
 	 * @param out - a file stream to print to.
@@ -148,6 +207,11 @@ public:
 
 private:
 
+	inline bool read_bytes(void* buffer, size_t size) noexcept {
+		return _mapped ? _map.read_bytes(static_cast<uint8_t*>(buffer), size)
+		               : _file.read_bytes(static_cast<uint8_t*>(buffer), size);
+	}
+
 	static inline void header_bytes_swap(pcap_hdr& hdr) noexcept {
 		hdr.magic_number = __builtin_bswap32(hdr.magic_number);
 		hdr.version_major = __builtin_bswap16(hdr.version_major);
@@ -162,7 +226,7 @@ private:
 		rec.ts_sec = __builtin_bswap32(rec.ts_sec);
 		rec.ts_usec = __builtin_bswap32(rec.ts_usec);
 		rec.incl_len = __builtin_bswap32(rec.incl_len);
-		rec.ts_sec = __builtin_bswap32(rec.ts_sec);
+		rec.orig_len = __builtin_bswap32(rec.orig_len);
 	}
 
 };
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Pcap.h"
+
+namespace pcap {
+
+/**
+ * Writer writes the frames into a PCAP file of the microsecond timestamps and the Ethernet link type.
+ * The records are accumulated in a large buffer which is written with a single 'write()' call.
+ **/
+class Writer {
+public:
+
+	static constexpr size_t DEFAULT_CAPACITY = 4u << 20u;
+	static constexpr uint32_t LINKTYPE_ETHERNET = 1u;
+
+protected:
+
+	const std::string _file_name;
+	std::unique_ptr<uint8_t[]> _buffer;
+	const size_t _capacity;
+	size_t _size;
+	int _fd;
+	uint64_t _frames;
+	uint64_t _bytes; // the bytes written including the headers
+
+public:
+
+	Writer(const Writer&) = delete;
+	Writer& operator=(const Writer&) = delete;
+
+	/**
+	 * @param file_name - PCAP file path, "-" is stdout.
+	 * @param capacity - the buffer size, at least a record of FRAME_SIZE_LIMIT bytes.
+	 */
+	explicit Writer(std::string file_name, size_t capacity = DEFAULT_CAPACITY) noexcept :
+		_file_name(std::move(file_name)),
+		_buffer(),
+		_capacity(capacity > sizeof(pcaprec_hdr) + Limits::FRAME_SIZE_LIMIT
+		          ? capacity : sizeof(pcaprec_hdr) + Limits::FRAME_SIZE_LIMIT),
+		_size(0),
+		_fd(-1),
+		_frames(0),
+		_bytes(0) {}
+
+	~Writer() noexcept {
+		close();
+	}
+
+	inline uint64_t frames() const noexcept {
+		return _frames;
+	}
+
+	inline uint64_t bytes() const noexcept {
+		return _bytes;
+	}
+
+	/**
+	 * Create the file and write the PCAP file header.
+	 * @return false - in case on any errors.
+	 */
+	bool open() noexcept {
+		_fd = _file_name == "-" ? STDOUT_FILENO : ::open(_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if(_fd < 0) {
+			fprintf(stderr, "'%s' : open() failed: %s\n", _file_name.c_str(), strerror(errno));
+			return false;
+		}
+		_buffer.reset(new uint8_t[_capacity]);
+
+		pcap_hdr header;
+		header.magic_number = MAGIC_NUMBER;
+		header.version_major = Limits::VER_MIN_MAJOR;
+		header.version_minor = 4u;
+		header.thiszone = 0;
+		header.sigfigs = 0;
+		header.snaplen = Limits::FRAME_SIZE_LIMIT;
+		header.network = LINKTYPE_ETHERNET;
+		put(&header, sizeof(header));
+		return true;
+	}
+
+	/**
+	 * @param ts - the capture timestamp in nanoseconds, it is truncated to microseconds.
+	 * @return false - in case of a write error.
+	 */
+	inline bool write(const uint8_t* frame, size_t size, uint64_t ts) noexcept {
+		if(_size + sizeof(pcaprec_hdr) + size > _capacity && not flush()) {
+			return false;
+		}
+		pcaprec_hdr record;
+		record.ts_sec = uint32_t(ts / 1000000000ull);
+		record.ts_usec = uint32_t(ts % 1000000000ull / 1000ull);
+		record.incl_len = uint32_t(size);
+		record.orig_len = uint32_t(size);
+		put(&record, sizeof(record));
+		put(frame, size);
+		_frames++;
+		return true;
+	}
+
+	/**
+	 * Write the buffered records out and close the file.
+	 * @return false - in case of a write error.
+	 */
+	bool close() noexcept {
+		bool result = true;
+		if(_fd >= 0) {
+			result = flush();
+			if(_fd != STDOUT_FILENO && ::close(_fd) != 0) {
+				result = false;
+			}
+			_fd = -1;
+		}
+		return result;
+	}
+
+protected:
+
+	inline void put(const void* data, size_t size) noexcept {
+		memcpy(_buffer.get() + _size, data, size);
+		_size += size;
+		_bytes += size;
+	}
+
+	bool flush() noexcept {
+		const uint8_t* ptr = _buffer.get();
+		size_t left = _size;
+		_size = 0;
+		while(left > 0) {
+			const ssize_t written = ::write(_fd, ptr, left);
+			if(written < 0) {
+				if(errno == EINTR) {
+					continue;
+				}
+				fprintf(stderr, "'%s' : write() failed: %s\n", _file_name.c_str(), strerror(errno));
+				return false;
+			}
+			ptr += written;
+			left -= size_t(written);
+		}
+		return true;
+	}
+
+};
+
+}; // namespace pcap
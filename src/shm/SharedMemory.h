@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace shm {
+
+/**
+ * SharedMemory is a POSIX shared memory object mapped into the process.
+ * The object is not unlinked on destruction, it outlives the writer so readers might attach at any time.
+ **/
+class SharedMemory {
+
+	void* _addr;
+	size_t _size;
+
+public:
+
+	SharedMemory(const SharedMemory&) = delete;
+	SharedMemory& operator=(const SharedMemory&) = delete;
+
+	SharedMemory() noexcept : _addr(nullptr), _size(0) {}
+
+	~SharedMemory() noexcept {
+		close();
+	}
+
+	/**
+	 * Create (or recreate) the object with @size bytes and map it for writing, the memory is zero filled.
+	 * An existing object is unlinked rather than truncated, so its readers keep a valid mapping
+	 * (and don't get SIGBUS) until they attach to the new one.
+	 * @param name - the object name, e.g. "/simba-tob".
+	 * @return false - in case of any errors.
+	 */
+	bool create(const char* name, size_t size) noexcept {
+		close();
+		if(shm_unlink(name) != 0 && errno != ENOENT) {
+			fprintf(stderr, "'%s' : shm_unlink() failed: %s\n", name, strerror(errno));
+			return false;
+		}
+		const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+		if(fd < 0) {
+			fprintf(stderr, "'%s' : shm_open() failed: %s\n", name, strerror(errno));
+			return false;
+		}
+
+		bool result = ftruncate(fd, off_t(size)) == 0;
+		if(result) {
+			result = map(fd, size, PROT_READ | PROT_WRITE);
+		} else {
+			fprintf(stderr, "'%s' : ftruncate() failed: %s\n", name, strerror(errno));
+		}
+		::close(fd);
+		return result;
+	}
+
+	/**
+	 * Map an existing object for reading.
+	 * @param name - the object name, e.g. "/simba-tob".
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* name) noexcept {
+		close();
+		const int fd = shm_open(name, O_RDONLY, 0);
+		if(fd < 0) {
+			fprintf(stderr, "'%s' : shm_open() failed: %s\n", name, strerror(errno));
+			return false;
+		}
+
+		const off_t size = lseek(fd, 0, SEEK_END);
+		bool result = size > 0 && map(fd, size_t(size), PROT_READ);
+		::close(fd);
+		return result;
+	}
+
+	/**
+	 * Remove the object name, the mapped memory stays valid until it is unmapped.
+	 */
+	static inline void unlink(const char* name) noexcept {
+		shm_unlink(name);
+	}
+
+	inline void close() noexcept {
+		if(_addr) {
+			munmap(_addr, _size);
+			_addr = nullptr;
+			_size = 0;
+		}
+	}
+
+	inline void* get() const noexcept {
+		return _addr;
+	}
+
+	inline size_t size() const noexcept {
+		return _size;
+	}
+
+private:
+
+	bool map(int fd, size_t size, int prot) noexcept {
+		void* addr = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+		if(addr == MAP_FAILED) {
+			fprintf(stderr, "mmap() failed: %s\n", strerror(errno));
+			return false;
+		}
+		_addr = addr;
+		_size = size;
+		return true;
+	}
+
+};
+
+}; // namespace shm
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include "SharedMemory.h"
+#include "../concurrent/SeqLock.h"
+#include "../book/TopOfBook.h"
+
+namespace shm {
+
+/**
+ * The shared memory region layout:
+ *
+ *   | RegionHeader | Record[0] | Record[1] | ... | Record[capacity - 1] |
+ *
+ * Every part is cache line aligned. Record 'i' belongs to the security with the dense index 'i',
+ * so a record never moves once it has been published. A record with zero sequence is not published yet.
+ **/
+
+static constexpr uint64_t TOB_MAGIC = 0x424F542D41424D53ull; // "SMBA-TOB"
+static constexpr uint32_t TOB_VERSION = 1u;
+static constexpr uint32_t TOB_LEVELS = book::TopOfBook::LEVELS;
+
+using TopOfBook = book::TopOfBook;
+using Record = concurrent::SeqLock<TopOfBook>;
+
+struct alignas(concurrent::CACHE_LINE_SIZE) RegionHeader {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t levels;
+	uint32_t record_size;
+	uint32_t capacity;
+	std::atomic<uint32_t> count; // records [0, count) might be published
+};
+
+static inline constexpr size_t region_size(uint32_t capacity) noexcept {
+	return sizeof(RegionHeader) + sizeof(Record) * capacity;
+}
+
+/**
+ * TopOfBookPublisher is a book::BookBuilder listener which publishes the top levels of every book
+ * into a shared memory region. There must be a single publisher per region.
+ * Several book builders might share the publisher if every security is updated by a single builder
+ * (see book::ShardedBookBuilder).
+ **/
+class TopOfBookPublisher {
+protected:
+	SharedMemory _memory;
+	RegionHeader* _header;
+	Record* _records;
+	std::atomic<uint64_t> _published;
+	std::atomic<uint64_t> _overflows;
+
+public:
+
+	TopOfBookPublisher() noexcept :
+		_memory(),
+		_header(nullptr),
+		_records(nullptr),
+		_published(0),
+		_overflows(0) {}
+
+	/**
+	 * @param name - the shared memory object name.
+	 * @param capacity - the maximum number of securities.
+	 * @return false - in case of any errors.
+	 */
+	bool open(const char* name, uint32_t capacity) noexcept {
+		if(not _memory.create(name, region_size(capacity))) {
+			return false;
+		}
+		// A new object is zero filled, so all the records are not published.
+		_header = static_cast<RegionHeader*>(_memory.get());
+		_records = reinterpret_cast<Record*>(_header + 1);
+		_header->version = TOB_VERSION;
+		_header->levels = TOB_LEVELS;
+		_header->record_size = sizeof(Record);
+		_header->capacity = capacity;
+		_header->count.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		reinterpret_cast<std::atomic<uint64_t>*>(&_header->magic)->store(TOB_MAGIC, std::memory_order_release);
+		return true;
+	}
+
+	// book::BookBuilder listener
+
+	void on_book_update(book::Security& sec, const book::DepthView::Changes& changes) noexcept {
+		if(not TopOfBook::affected(changes)) {
+			return;
+		}
+		publish(sec, [&sec](TopOfBook& tob) {
+			tob.assign(sec);
+		});
+	}
+
+	void on_book_cleared(book::Security& sec) noexcept {
+		publish(sec, [&sec](TopOfBook& tob) {
+			tob.clear(sec);
+		});
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "TopOfBookPublisher [");
+		fprintf(out, " published=%lu", _published.load());
+		fprintf(out, " overflows=%lu", _overflows.load());
+		fprintf(out, " ]\n");
+	}
+
+protected:
+
+	template <typename Fn>
+	void publish(const book::Security& sec, Fn&& fn) noexcept {
+		if(sec.idx >= _header->capacity) {
+			_overflows.fetch_add(1u, std::memory_order_relaxed);
+			return;
+		}
+
+		_records[sec.idx].update(fn);
+
+		uint32_t count = _header->count.load(std::memory_order_relaxed);
+		while(sec.idx >= count) {
+			if(_header->count.compare_exchange_weak(count, sec.idx + 1u, std::memory_order_release)) {
+				break;
+			}
+		}
+		_published.fetch_add(1u, std::memory_order_relaxed);
+	}
+
+};
+
+/**
+ * TopOfBookReader polls the records published by TopOfBookPublisher.
+ * Reading is lock free and doesn't make any system calls.
+ **/
+class TopOfBookReader {
+protected:
+	SharedMemory _memory;
+	const RegionHeader* _header;
+	const Record* _records;
+
+public:
+
+	TopOfBookReader() noexcept :
+		_memory(),
+		_header(nullptr),
+		_records(nullptr) {}
+
+	/**
+	 * @param name - the shared memory object name.
+	 * @return false - in case of any errors or an incompatible region.
+	 */
+	bool open(const char* name) noexcept {
+		if(not _memory.open(name)) {
+			return false;
+		}
+		const auto* header = static_cast<const RegionHeader*>(_memory.get());
+		if(_memory.size() < sizeof(RegionHeader) || header->magic != TOB_MAGIC || header->version != TOB_VERSION
+		   || header->record_size != sizeof(Record) || _memory.size() < region_size(header->capacity)) {
+			fprintf(stderr, "'%s' : the region is not compatible\n", name);
+			return false;
+		}
+		_header = header;
+		_records = reinterpret_cast<const Record*>(_header + 1);
+		return true;
+	}
+
+	/**
+	 * @return The number of records which might be published.
+	 */
+	inline uint32_t count() const noexcept {
+		return _header->count.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * @return The record sequence, it is zero for the records which are not published yet.
+	 */
+	inline uint32_t version(uint32_t idx) const noexcept {
+		return _records[idx].version();
+	}
+
+	/**
+	 * Make a consistent copy of the record 'idx'.
+	 * @return false - if the record is not published yet.
+	 */
+	inline bool read(uint32_t idx, TopOfBook& tob) const noexcept {
+		if(idx >= count() || version(idx) == 0) {
+			return false;
+		}
+		_records[idx].read(tob);
+		return true;
+	}
+
+	/**
+	 * @return The index of the record of @security_id or UINT32_MAX.
+	 */
+	uint32_t find(int32_t security_id) const noexcept {
+		TopOfBook tob;
+		const uint32_t records = count();
+		for(uint32_t idx = 0; idx < records; ++idx) {
+			if(read(idx, tob) && tob.security_id == security_id) {
+				return idx;
+			}
+		}
+		return UINT32_MAX;
+	}
+
+	void dump(FILE* out) const noexcept {
+		TopOfBook tob;
+		const uint32_t records = count();
+		for(uint32_t idx = 0; idx < records; ++idx) {
+			if(read(idx, tob)) {
+				tob.dump(out);
+			}
+		}
+	}
+
+};
+
+}; // namespace shm
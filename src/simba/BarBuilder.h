@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../output/TextBuffer.h"
+#include "../book/SecurityMap.h"
+
+#include "Handler.h"
+
+namespace simba {
+
+/**
+ * BarBuilder aggregates the trades, OrderExecution::last_px and last_qty, into the OHLCV bars
+ * of every security for up to MAX_INTERVALS bar intervals by sending_time, a CSV line per bar:
+ *
+ *   security_id,interval,start,open,high,low,close,volume,trades,vwap
+ *   4,1000000000,1600000000000000000,1000.31000,1009.31000,1000.03000,1006.55000,152,27,1004.51368
+ *
+ * 'interval' and 'start' are nanoseconds. The prices are exact and written with all the digits of the price
+ * scale, the accumulators are fixed-point: the turnover is the 128-bit sum of the price mantissa by the quantity,
+ * VWAP is rounded to the price scale.
+ *
+ * A bar is written when it closes: the first trade of a later interval of any security closes all the bars
+ * of the earlier intervals, the remaining ones are written by close(). A trade which is older than
+ * the latest interval is added to the bar of the latest interval.
+ * The bars are kept in the arrays indexed by the dense security index, so nothing is allocated
+ * once all the securities have been seen.
+ **/
+class BarBuilder : public Handler {
+public:
+
+	static constexpr size_t MAX_INTERVALS = 4u;
+
+protected:
+
+	struct Bar {
+		uint64_t window; // the interval number, start / interval
+		int64_t open;
+		int64_t high;
+		int64_t low;
+		int64_t close;
+		int64_t volume;
+		uint64_t trades; // 0 - the bar is empty
+		__int128 turnover;
+	};
+
+	output::TextBuffer& _out;
+	uint64_t _intervals[MAX_INTERVALS];
+	size_t _count;
+	uint64_t _windows[MAX_INTERVALS]; // the latest interval number seen
+	book::SecurityMap _securities;
+	std::vector<int32_t> _ids;        // the dense index -> security_id
+	std::vector<Bar> _bars[MAX_INTERVALS];
+	uint64_t _sending_time;
+	uint64_t _written;
+
+public:
+
+	BarBuilder(const BarBuilder&) = delete;
+	BarBuilder& operator=(const BarBuilder&) = delete;
+
+	/**
+	 * @param intervals - the bar intervals in nanoseconds, @count is at most MAX_INTERVALS.
+	 */
+	BarBuilder(output::TextBuffer& out, const uint64_t* intervals, size_t count) noexcept :
+		_out(out),
+		_intervals(),
+		_count(count < MAX_INTERVALS ? count : MAX_INTERVALS),
+		_windows(),
+		_securities(),
+		_ids(),
+		_bars(),
+		_sending_time(0),
+		_written(0) {
+		for(size_t idx = 0; idx < _count; ++idx) {
+			_intervals[idx] = intervals[idx];
+		}
+		_out.append("security_id,interval,start,open,high,low,close,volume,trades,vwap\n");
+	}
+
+	/**
+	 * Write all the bars which are not closed yet.
+	 */
+	void close() noexcept {
+		for(size_t i = 0; i < _count; ++i) {
+			for(uint32_t idx = 0; idx < _bars[i].size(); ++idx) {
+				write(i, idx);
+			}
+		}
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "BarBuilder [ securities=%zu bars=%lu ]\n", _ids.size(), _written);
+	}
+
+	// simba::Handler
+
+	inline void on_packet_header(const MarketDataPacketHeader& header) noexcept {
+		_sending_time = header.sending_time;
+	}
+
+	inline void on_order_execution(const OrderExecution& msg) noexcept {
+		const uint32_t idx = security(msg.security_id);
+		const int64_t px = msg.last_px._value;
+		const int64_t qty = msg.last_qty;
+		for(size_t i = 0; i < _count; ++i) {
+			const uint64_t window = _sending_time / _intervals[i];
+			if(window > _windows[i]) {
+				// The first trade of the interval closes the bars of all the earlier intervals.
+				for(uint32_t other = 0; other < _bars[i].size(); ++other) {
+					write(i, other);
+				}
+				_windows[i] = window;
+			}
+
+			Bar& bar = _bars[i][idx];
+			if(bar.trades == 0) {
+				bar.window = _windows[i];
+				bar.open = px;
+				bar.high = px;
+				bar.low = px;
+			} else {
+				bar.high = px > bar.high ? px : bar.high;
+				bar.low = px < bar.low ? px : bar.low;
+			}
+			bar.close = px;
+			bar.volume += qty;
+			bar.trades++;
+			bar.turnover += __int128(px) * qty;
+		}
+	}
+
+protected:
+
+	/**
+	 * @return The dense index of the security, the bars are added on the first trade.
+	 */
+	inline uint32_t security(int32_t id) noexcept {
+		const uint32_t idx = _securities.insert(id);
+		if(idx == _ids.size()) {
+			_ids.push_back(id);
+			for(size_t i = 0; i < _count; ++i) {
+				_bars[i].push_back(Bar());
+			}
+		}
+		return idx;
+	}
+
+	/**
+	 * Write the bar of the security @idx if it is not empty and reset it.
+	 */
+	void write(size_t i, uint32_t idx) noexcept {
+		Bar& bar = _bars[i][idx];
+		if(bar.trades == 0) {
+			return;
+		}
+
+		_out.append_int(_ids[idx]).append_char(',');
+		_out.append_uint(_intervals[i]).append_char(',');
+		_out.append_uint(bar.window * _intervals[i]).append_char(',');
+		_out.append_decimal(bar.open, Decimal5::DIVISOR).append_char(',');
+		_out.append_decimal(bar.high, Decimal5::DIVISOR).append_char(',');
+		_out.append_decimal(bar.low, Decimal5::DIVISOR).append_char(',');
+		_out.append_decimal(bar.close, Decimal5::DIVISOR).append_char(',');
+		_out.append_int(bar.volume).append_char(',');
+		_out.append_uint(bar.trades).append_char(',');
+		if(bar.volume > 0) {
+			_out.append_decimal(vwap(bar.turnover, bar.volume), Decimal5::DIVISOR);
+		}
+		_out.append_char('\n');
+
+		bar = Bar();
+		_written++;
+	}
+
+	/**
+	 * @return turnover / volume rounded half away from zero.
+	 */
+	static inline int64_t vwap(__int128 turnover, int64_t volume) noexcept {
+		const __int128 half = volume / 2;
+		return int64_t(turnover >= 0 ? (turnover + half) / volume : (turnover - half) / volume);
+	}
+
+};
+
+}; // namespace simba
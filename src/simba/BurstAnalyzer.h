@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#include "Handler.h"
+
+namespace simba {
+
+/**
+ * BurstAnalyzer measures the peak message rates: the messages are counted in the fixed windows
+ * of up to MAX_WINDOWS sizes, e.g. 1us, 100us and 1ms, aligned to the clock epoch.
+ * Both sending_time and the capture timestamp are used as clocks.
+ *
+ * Every window size has a series for all the messages, per channel (the incremental and the snapshot packets)
+ * and per template. A series keeps the maximum and a log-linear histogram of the message counts
+ * of the non-empty windows, the percentiles are accurate to 1/8 of the value.
+ * The 'top' largest windows of all the messages are kept with their frame indices.
+ * The memory is allocated once by the constructor.
+ *
+ * A message which is older than the current window of a series is counted in the current window.
+ **/
+class BurstAnalyzer : public Handler {
+public:
+
+	static constexpr size_t MAX_WINDOWS = 4u;
+	static constexpr size_t TEMPLATES = 16u; // the template ids above are counted as 'other'
+
+	enum class Clock : uint8_t {
+		Sending,
+		Capture,
+		COUNT
+	};
+
+protected:
+
+	static constexpr size_t ALL = 0u;
+	static constexpr size_t INCREMENTAL = 1u;
+	static constexpr size_t SNAPSHOT = 2u;
+	static constexpr size_t TEMPLATE_BASE = 3u;
+	static constexpr size_t SERIES = TEMPLATE_BASE + TEMPLATES + 1u;
+	static constexpr size_t CLOCKS = size_t(Clock::COUNT);
+
+	/**
+	 * The values below LINEAR are exact, above them every power of two is split into SUB_BUCKETS.
+	 */
+	struct Histogram {
+		static constexpr uint32_t LINEAR = 32u;
+		static constexpr uint32_t SUB_BITS = 3u;
+		static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BITS;
+		static constexpr uint32_t FIRST_EXP = 5u; // log2(LINEAR)
+		static constexpr uint32_t SLOTS = LINEAR + (64u - FIRST_EXP) * SUB_BUCKETS;
+
+		uint64_t slots[SLOTS];
+
+		static inline uint32_t slot(uint64_t value) noexcept {
+			if(value < LINEAR) {
+				return uint32_t(value);
+			}
+			const uint32_t exp = 63u - uint32_t(__builtin_clzll(value));
+			const uint32_t sub = uint32_t(value >> (exp - SUB_BITS)) & (SUB_BUCKETS - 1u);
+			return LINEAR + (exp - FIRST_EXP) * SUB_BUCKETS + sub;
+		}
+
+		/**
+		 * @return The lower bound of the values of @slot.
+		 */
+		static inline uint64_t value(uint32_t slot) noexcept {
+			if(slot < LINEAR) {
+				return slot;
+			}
+			const uint32_t exp = (slot - LINEAR) / SUB_BUCKETS + FIRST_EXP;
+			const uint64_t sub = (slot - LINEAR) % SUB_BUCKETS;
+			return (1ull << exp) | (sub << (exp - SUB_BITS));
+		}
+
+		/**
+		 * @param total - the number of the values added.
+		 */
+		uint64_t percentile(uint64_t total, double p) const noexcept {
+			const uint64_t rank = uint64_t(double(total) * p / 100.0);
+			uint64_t seen = 0;
+			for(uint32_t idx = 0; idx < SLOTS; ++idx) {
+				seen += slots[idx];
+				if(seen > rank) {
+					return value(idx);
+				}
+			}
+			return 0;
+		}
+	};
+
+	struct Series {
+		uint64_t window;      // the current window number, time / size
+		uint64_t count;       // the messages of the current window
+		uint64_t first_frame; // the frames of the current window
+		uint64_t last_frame;
+		uint64_t windows;     // the closed non-empty windows
+		uint64_t messages;
+		uint64_t max;
+		Histogram histogram;
+	};
+
+	struct Burst {
+		uint64_t count;
+		uint64_t start; // the window start time in nanoseconds
+		uint64_t first_frame;
+		uint64_t last_frame;
+	};
+
+	uint64_t _sizes[MAX_WINDOWS]; // the window sizes in nanoseconds
+	size_t _windows;
+	size_t _top;
+	std::unique_ptr<Series[]> _series;  // [clock][window][series]
+	std::unique_ptr<Burst[]> _bursts;   // [clock][window][top]
+	uint64_t _time[CLOCKS];
+	uint64_t _frame_index;
+	size_t _channel;
+
+public:
+
+	BurstAnalyzer(const BurstAnalyzer&) = delete;
+	BurstAnalyzer& operator=(const BurstAnalyzer&) = delete;
+
+	/**
+	 * @param sizes - the window sizes in nanoseconds, @count is at most MAX_WINDOWS.
+	 * @param top - the number of the largest windows reported.
+	 */
+	BurstAnalyzer(const uint64_t* sizes, size_t count, size_t top) noexcept :
+		_sizes(),
+		_windows(count < MAX_WINDOWS ? count : MAX_WINDOWS),
+		_top(top),
+		_series(new Series[CLOCKS * MAX_WINDOWS * SERIES]),
+		_bursts(new Burst[CLOCKS * MAX_WINDOWS * (top ? top : 1u)]),
+		_time(),
+		_frame_index(0),
+		_channel(SNAPSHOT) {
+		memcpy(_sizes, sizes, _windows * sizeof(uint64_t));
+		memset(_series.get(), 0, CLOCKS * MAX_WINDOWS * SERIES * sizeof(Series));
+		memset(_bursts.get(), 0, CLOCKS * MAX_WINDOWS * (top ? top : 1u) * sizeof(Burst));
+	}
+
+	// simba::Handler
+
+	inline void on_frame(const pcap::Frame& frame) noexcept {
+		_time[size_t(Clock::Capture)] = frame.timestamp();
+		_frame_index = frame.index();
+	}
+
+	inline void on_packet_header(const MarketDataPacketHeader& header) noexcept {
+		_time[size_t(Clock::Sending)] = header.sending_time;
+		_channel = header.has_flag(MarketDataPacketHeader::Flags::IncrementalPacket) ? INCREMENTAL : SNAPSHOT;
+	}
+
+	inline void on_message_header(const SBEMessageHeader& header) noexcept {
+		const size_t id = static_cast<uint16_t>(header.template_id);
+		const size_t tmpl = TEMPLATE_BASE + (id < TEMPLATES ? id : TEMPLATES);
+		for(size_t clock = 0; clock < CLOCKS; ++clock) {
+			for(size_t w = 0; w < _windows; ++w) {
+				const uint64_t window = _time[clock] / _sizes[w];
+				Series* series = &_series[(clock * MAX_WINDOWS + w) * SERIES];
+				add(clock, w, series[ALL], window, true);
+				add(clock, w, series[_channel], window, false);
+				add(clock, w, series[tmpl], window, false);
+			}
+		}
+	}
+
+	/**
+	 * Close the current windows and print the report.
+	 */
+	void dump(FILE* out) noexcept {
+		static const char* clock_names[] = {"sending_time", "capture"};
+		for(size_t clock = 0; clock < CLOCKS; ++clock) {
+			for(size_t w = 0; w < _windows; ++w) {
+				Series* series = &_series[(clock * MAX_WINDOWS + w) * SERIES];
+				for(size_t idx = 0; idx < SERIES; ++idx) {
+					if(idx == ALL) {
+						offer(clock, w, series[idx]);
+					}
+					close(series[idx]);
+				}
+
+				fprintf(out, "Bursts [ clock=%s window=%luns ]\n", clock_names[clock], _sizes[w]);
+				fprintf(out, "  %-24s %12s %12s %8s %8s %8s %8s %8s %14s\n", "series", "messages", "windows",
+				        "p50", "p90", "p99", "p99.9", "max", "max_rate/s");
+				for(size_t idx = 0; idx < SERIES; ++idx) {
+					const Series& s = series[idx];
+					if(s.windows == 0) {
+						continue;
+					}
+					fprintf(out, "  %-24s %12lu %12lu %8lu %8lu %8lu %8lu %8lu %14.0f\n", series_name(idx),
+					        s.messages, s.windows,
+					        s.histogram.percentile(s.windows, 50.0), s.histogram.percentile(s.windows, 90.0),
+					        s.histogram.percentile(s.windows, 99.0), s.histogram.percentile(s.windows, 99.9),
+					        s.max, double(s.max) * 1e9 / double(_sizes[w]));
+				}
+
+				Burst* bursts = &_bursts[(clock * MAX_WINDOWS + w) * _top];
+				std::sort(bursts, bursts + _top, [](const Burst& a, const Burst& b) {
+					return a.count > b.count || (a.count == b.count && a.start < b.start);
+				});
+				for(size_t rank = 0; rank < _top && bursts[rank].count; ++rank) {
+					const Burst& burst = bursts[rank];
+					fprintf(out, "  top %-3zu messages=%lu start=%lu frames=%lu..%lu\n", rank + 1u, burst.count,
+					        burst.start, burst.first_frame, burst.last_frame);
+				}
+			}
+		}
+	}
+
+protected:
+
+	static const char* series_name(size_t idx) noexcept {
+		switch(idx) {
+			case ALL: return "all";
+			case INCREMENTAL: return "incremental";
+			case SNAPSHOT: return "snapshot";
+			case TEMPLATE_BASE + TEMPLATES: return "other";
+			default:
+				return template_id_name(static_cast<TemplateId>(idx - TEMPLATE_BASE));
+		}
+	}
+
+	/**
+	 * Count a message of @window, the current window of @series is closed if @window is newer.
+	 * @param top - offer the closed window to the top bursts.
+	 */
+	inline void add(size_t clock, size_t w, Series& series, uint64_t window, bool top) noexcept {
+		if(window > series.window) {
+			if(top) {
+				offer(clock, w, series);
+			}
+			close(series);
+			series.window = window;
+		}
+		if(series.count == 0) {
+			series.first_frame = _frame_index;
+		}
+		series.count++;
+		series.messages++;
+		series.last_frame = _frame_index;
+	}
+
+	static inline void close(Series& series) noexcept {
+		if(series.count) {
+			series.windows++;
+			series.histogram.slots[Histogram::slot(series.count)]++;
+			if(series.count > series.max) {
+				series.max = series.count;
+			}
+		}
+		series.count = 0;
+	}
+
+	/**
+	 * Offer the current window of the 'all' series to the top bursts.
+	 */
+	inline void offer(size_t clock, size_t w, const Series& series) noexcept {
+		if(_top == 0 || series.count == 0) {
+			return;
+		}
+		Burst* bursts = &_bursts[(clock * MAX_WINDOWS + w) * _top];
+		Burst* min = bursts;
+		for(size_t idx = 1; idx < _top; ++idx) {
+			if(bursts[idx].count < min->count) {
+				min = &bursts[idx];
+			}
+		}
+		if(series.count > min->count) {
+			*min = Burst{series.count, series.window * _sizes[w], series.first_frame, series.last_frame};
+		}
+	}
+
+};
+
+}; // namespace simba
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../output/TextBuffer.h"
+
+#include "Handler.h"
+
+namespace simba {
+
+/**
+ * DumpHandler prints every decoded structure preceded by the frame state.
+ */
+class DumpHandler : public Handler {
+protected:
+	output::TextBuffer& _out;
+
+public:
+
+	explicit DumpHandler(output::TextBuffer& out) noexcept : _out(out) {}
+
+	inline void on_frame(const pcap::Frame& frame) noexcept {
+		_out.append("Frame [idx=").append_uint(frame.index());
+		_out.append(" off=").append_uint(frame.offset());
+		_out.append(" avl=").append_uint(frame.available());
+		_out.append(" pad=").append_uint(frame.padding());
+		_out.append("] | ");
+	}
+
+	inline void on_packet_header(const MarketDataPacketHeader& header) noexcept {
+		header.dump(_out);
+	}
+
+	inline void on_incremental_header(const IncrementalHeader& header) noexcept {
+		header.dump(_out);
+	}
+
+	inline void on_message_header(const SBEMessageHeader& header) noexcept {
+		header.dump(_out);
+	}
+
+	inline void on_order_update(const OrderUpdate& msg) noexcept {
+		msg.dump(_out);
+	}
+
+	inline void on_order_execution(const OrderExecution& msg) noexcept {
+		msg.dump(_out);
+	}
+
+	inline void on_snapshot_root(const OrderBookSnapshotRoot& msg) noexcept {
+		msg.dump(_out);
+	}
+
+	inline void on_group_size(const GroupSize& group) noexcept {
+		group.dump(_out);
+	}
+
+	inline void on_snapshot_entry(const OrderBookSnapshotEntry& entry) noexcept {
+		entry.dump(_out);
+	}
+
+	inline void on_empty_book(const EmptyBook& msg) noexcept {
+		msg.dump(_out);
+	}
+
+	inline void on_security_status(const SecurityStatus& msg) noexcept {
+		msg.dump(_out);
+	}
+
+	inline void on_trading_session_status(const TradingSessionStatus& msg) noexcept {
+		msg.dump(_out);
+	}
+
+};
+
+}; // namespace simba
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "simba.h"
+#include "SnapshotColumns.h"
+#include "../pcap/Frame.h"
+
+namespace simba {
+
+/**
+ * Handler is a base class for SimbaParser consumers.
+ * SimbaParser::parse() is a template, so the calls are resolved statically and a derived class
+ * should hide only the methods it is interested in. The rest are empty and inlined away.
+ *
+ * The call sequence for a packet:
+ *
+ *   on_frame() on_packet_header()
+ *   [on_frame() on_incremental_header()]
+ *   {
+ *     on_frame() on_message_header()
+ *     on_frame() on_order_update() | on_order_execution() |
+ *     on_frame() on_snapshot_root() on_frame() on_group_size() {on_frame() on_snapshot_entry()} |
+ *     on_frame() on_empty_book() | on_security_status() | on_trading_session_status()
+ *   }
+ *
+ * on_frame() is called before every structure is read, the frame head points to the structure.
+ * A handler which declares SNAPSHOT_COLUMNS receives the snapshot entries of a message at once:
+ *
+ *     on_frame() on_snapshot_root() on_frame() on_group_size() on_frame() on_snapshot_columns()
+ */
+struct Handler {
+
+	static constexpr bool SNAPSHOT_COLUMNS = false;
+
+	inline void on_frame(const pcap::Frame&) noexcept {}
+
+	inline void on_packet_header(const MarketDataPacketHeader&) noexcept {}
+
+	inline void on_incremental_header(const IncrementalHeader&) noexcept {}
+
+	inline void on_message_header(const SBEMessageHeader&) noexcept {}
+
+	inline void on_order_update(const OrderUpdate&) noexcept {}
+
+	inline void on_order_execution(const OrderExecution&) noexcept {}
+
+	inline void on_snapshot_root(const OrderBookSnapshotRoot&) noexcept {}
+
+	inline void on_group_size(const GroupSize&) noexcept {}
+
+	inline void on_snapshot_entry(const OrderBookSnapshotEntry&) noexcept {}
+
+	inline void on_snapshot_columns(const SnapshotColumns&) noexcept {}
+
+	inline void on_empty_book(const EmptyBook&) noexcept {}
+
+	inline void on_security_status(const SecurityStatus&) noexcept {}
+
+	inline void on_trading_session_status(const TradingSessionStatus&) noexcept {}
+
+};
+
+}; // namespace simba
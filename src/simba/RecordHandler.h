@@ -0,0 +1,345 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../output/TextBuffer.h"
+#include "../output/SplitWriter.h"
+#include "../book/SecurityMap.h"
+
+#include "Handler.h"
+#include "Schema.h"
+
+namespace simba {
+
+enum class RecordFormat : uint8_t {
+	None,
+	Csv,
+	Ndjson
+};
+
+inline bool record_format_of(const char* name, size_t length, RecordFormat& format) noexcept {
+	static const struct {
+		const char* name;
+		RecordFormat format;
+	} formats[] = {
+		{"none", RecordFormat::None},
+		{"csv", RecordFormat::Csv},
+		{"ndjson", RecordFormat::Ndjson},
+	};
+	for(const auto& f : formats) {
+		if(strlen(f.name) == length && memcmp(f.name, name, length) == 0) {
+			format = f.format;
+			return true;
+		}
+	}
+	return false;
+}
+
+using RecordFormats = RecordFormat[size_t(Table::COUNT)];
+
+/**
+ * Parse a format selection: 'FORMAT' for all the tables or 'TABLE:FORMAT[,TABLE:FORMAT...]',
+ * the tables which are not listed are not written.
+ * @return false - @spec is malformed.
+ */
+inline bool parse_record_formats(const char* spec, RecordFormats& formats) noexcept {
+	RecordFormat format;
+	if(record_format_of(spec, strlen(spec), format)) {
+		for(RecordFormat& f : formats) {
+			f = format;
+		}
+		return true;
+	}
+
+	for(RecordFormat& f : formats) {
+		f = RecordFormat::None;
+	}
+	while(*spec) {
+		const char* colon = strchr(spec, ':');
+		if(not colon) {
+			return false;
+		}
+		const char* end = strchr(colon, ',');
+		if(not end) {
+			end = colon + strlen(colon);
+		}
+
+		Table table;
+		if(not table_of(spec, size_t(colon - spec), table)
+		   || not record_format_of(colon + 1, size_t(end - colon - 1), formats[static_cast<uint8_t>(table)])) {
+			return false;
+		}
+		spec = *end ? end + 1 : end;
+	}
+	return true;
+}
+
+/**
+ * StreamOutput writes all the rows to a single buffer.
+ *
+ * A RecordHandler output provides:
+ *   output::TextBuffer& begin(Table table, int32_t security_id, bool& header) - the buffer for the next row,
+ *     @header is set if the CSV header of @table has not been written to the buffer yet.
+ *   void end() - the row is complete.
+ */
+class StreamOutput {
+protected:
+	output::TextBuffer& _out;
+	uint32_t _headers;
+
+public:
+
+	explicit StreamOutput(output::TextBuffer& out) noexcept : _out(out), _headers(0) {}
+
+	inline output::TextBuffer& begin(Table table, int32_t, bool& header) noexcept {
+		const uint32_t bit = 1u << static_cast<uint8_t>(table);
+		header = not (_headers & bit);
+		_headers |= bit;
+		return _out;
+	}
+
+	inline void end() noexcept {}
+};
+
+/**
+ * SplitOutput writes the rows to a file per security, '<dir>/<security_id>.<ext>',
+ * or to a file per table, '<dir>/<table>.<ext>', through output::SplitWriter.
+ * The extension is the format name if it is the same for all the written rows of the file, "txt" otherwise.
+ */
+class SplitOutput {
+public:
+
+	enum class Key : uint8_t {
+		SecurityId,
+		Template
+	};
+
+protected:
+	output::SplitWriter& _writer;
+	const Key _key;
+	const std::string _dir;
+	std::string _security_ext;
+	std::string _table_ext[size_t(Table::COUNT)];
+	book::SecurityMap _securities;
+	std::vector<uint32_t> _security_files; // the dense index of a security -> the file
+	uint32_t _table_files[size_t(Table::COUNT)];
+	uint32_t _current;
+
+public:
+
+	SplitOutput(output::SplitWriter& writer, Key key, const char* dir, const RecordFormats& formats) noexcept :
+		_writer(writer),
+		_key(key),
+		_dir(dir),
+		_security_ext(),
+		_table_ext(),
+		_securities(),
+		_security_files(),
+		_table_files(),
+		_current(output::SplitWriter::NONE) {
+		RecordFormat common = RecordFormat::None;
+		bool mixed = false;
+		for(uint8_t idx = 0; idx < uint8_t(Table::COUNT); ++idx) {
+			_table_files[idx] = output::SplitWriter::NONE;
+			_table_ext[idx] = extension(formats[idx]);
+			if(formats[idx] != RecordFormat::None) {
+				mixed = mixed || (common != RecordFormat::None && common != formats[idx]);
+				common = formats[idx];
+			}
+		}
+		_security_ext = mixed ? "txt" : extension(common);
+	}
+
+	inline output::TextBuffer& begin(Table table, int32_t security_id, bool& header) noexcept {
+		_current = _key == Key::SecurityId ? security_file(security_id) : table_file(table);
+		const uint32_t bit = 1u << static_cast<uint8_t>(table);
+		uint32_t& headers = _writer.tags(_current);
+		header = not (headers & bit);
+		headers |= bit;
+		return _writer.buffer(_current);
+	}
+
+	inline void end() noexcept {
+		_writer.commit(_current);
+	}
+
+protected:
+
+	static const char* extension(RecordFormat format) noexcept {
+		return format == RecordFormat::Ndjson ? "ndjson" : "csv";
+	}
+
+	inline uint32_t security_file(int32_t security_id) noexcept {
+		const uint32_t idx = _securities.insert(security_id);
+		if(idx == _security_files.size()) {
+			_security_files.push_back(_writer.add(_dir + "/" + std::to_string(security_id) + "." + _security_ext));
+		}
+		return _security_files[idx];
+	}
+
+	inline uint32_t table_file(Table table) noexcept {
+		uint32_t& file = _table_files[static_cast<uint8_t>(table)];
+		if(file == output::SplitWriter::NONE) {
+			const uint8_t idx = static_cast<uint8_t>(table);
+			file = _writer.add(_dir + "/" + table_schema(table).name + "." + _table_ext[idx]);
+		}
+		return file;
+	}
+};
+
+/**
+ * RecordHandler writes a row per message of every simba::Table in the format selected for the table:
+ *
+ *   CSV     - the first column is the table name, the header line is written before the first row of a table:
+ *             template,sending_time,msg_seq_num,...
+ *             OrderUpdate,1600000000000831585,2,...
+ *   NDJSON  - an object per line, the first key is the table name:
+ *             {"template":"OrderUpdate","sending_time":1600000000000831585,"msg_seq_num":2,...}
+ *
+ * The decimals are exact, a null is an empty CSV field or JSON null. The JSON bit sets (md_flags) are strings
+ * of the decimal number, the readers which parse the numbers as doubles keep 53 bits only.
+ * @tparam Output - where the rows go: StreamOutput or SplitOutput.
+ **/
+template <typename Output = StreamOutput>
+class RecordHandler : public Handler {
+protected:
+	Output& _output;
+	RecordFormats _formats;
+	RowContext _context;
+
+public:
+
+	RecordHandler(Output& output, const RecordFormats& formats) noexcept :
+		_output(output),
+		_formats(),
+		_context() {
+		memcpy(_formats, formats, sizeof(_formats));
+	}
+
+	// simba::Handler
+
+	inline void on_packet_header(const MarketDataPacketHeader& header) noexcept {
+		_context.sending_time = header.sending_time;
+		_context.msg_seq_num = header.msg_seq_num;
+	}
+
+	inline void on_order_update(const OrderUpdate& msg) noexcept {
+		write(Table::OrderUpdate, msg.security_id, &msg);
+	}
+
+	inline void on_order_execution(const OrderExecution& msg) noexcept {
+		write(Table::OrderExecution, msg.security_id, &msg);
+	}
+
+	inline void on_snapshot_root(const OrderBookSnapshotRoot& msg) noexcept {
+		_context.security_id = int32_t(msg.security_id);
+		_context.rpt_seq = msg.rpt_seq;
+	}
+
+	inline void on_snapshot_entry(const OrderBookSnapshotEntry& entry) noexcept {
+		write(Table::OrderBookSnapshot, _context.security_id, &entry);
+	}
+
+protected:
+
+	inline void write(Table table, int32_t security_id, const void* message) noexcept {
+		const RecordFormat format = _formats[static_cast<uint8_t>(table)];
+		if(format == RecordFormat::None) {
+			return;
+		}
+
+		bool header;
+		output::TextBuffer& out = _output.begin(table, security_id, header);
+		if(format == RecordFormat::Csv) {
+			if(header) {
+				write_csv_header(out, table_schema(table));
+			}
+			write_csv(out, table_schema(table), message);
+		} else {
+			write_json(out, table_schema(table), message);
+		}
+		_output.end();
+	}
+
+	static void write_csv_header(output::TextBuffer& out, const TableSchema& schema) noexcept {
+		out.append("template");
+		for(uint16_t idx = 0; idx < schema.count; ++idx) {
+			out.append_char(',').append(schema.fields[idx].name, schema.fields[idx].name_length);
+		}
+		out.append_char('\n');
+	}
+
+	void write_csv(output::TextBuffer& out, const TableSchema& schema, const void* message) noexcept {
+		out.append_str(schema.name);
+		for(uint16_t idx = 0; idx < schema.count; ++idx) {
+			const Field& field = schema.fields[idx];
+			const int64_t value = field.load(message, &_context);
+			out.append_char(',');
+			if(field.is_null(value)) {
+				continue;
+			}
+			if(field.kind == FieldKind::Char) {
+				const char c = char(value);
+				if(c == ',' || c == '"' || c == '\n' || c == '\r') {
+					out.append_char('"');
+					if(c == '"') {
+						out.append_char('"');
+					}
+					out.append_char(c).append_char('"');
+				} else {
+					out.append_char(c);
+				}
+				continue;
+			}
+			append_number(out, field, value);
+		}
+		out.append_char('\n');
+	}
+
+	void write_json(output::TextBuffer& out, const TableSchema& schema, const void* message) noexcept {
+		out.append("{\"template\":\"").append_str(schema.name).append_char('"');
+		for(uint16_t idx = 0; idx < schema.count; ++idx) {
+			const Field& field = schema.fields[idx];
+			const int64_t value = field.load(message, &_context);
+			out.append(",\"").append(field.name, field.name_length).append("\":");
+			if(field.is_null(value)) {
+				out.append("null");
+				continue;
+			}
+			if(field.kind == FieldKind::Char) {
+				const unsigned char c = static_cast<unsigned char>(value);
+				out.append_char('"');
+				if(c < 0x20u || c == '"' || c == '\\' || c >= 0x7Fu) {
+					static const char hex[] = "0123456789abcdef";
+					out.append("\\u00").append_char(hex[c >> 4u]).append_char(hex[c & 0xFu]);
+				} else {
+					out.append_char(char(c));
+				}
+				out.append_char('"');
+				continue;
+			}
+			if(field.flags & FIELD_BITS) {
+				out.append_char('"').append_uint(uint64_t(value)).append_char('"');
+				continue;
+			}
+			append_number(out, field, value);
+		}
+		out.append("}\n");
+	}
+
+	static inline void append_number(output::TextBuffer& out, const Field& field, int64_t value) noexcept {
+		if(field.kind == FieldKind::UInt) {
+			out.append_uint(uint64_t(value));
+		} else if(field.scale) {
+			out.append_decimal(value, field.divisor);
+		} else {
+			out.append_int(value);
+		}
+	}
+
+};
+
+}; // namespace simba
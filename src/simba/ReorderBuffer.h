@@ -0,0 +1,265 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include "../pcap/Frame.h"
+
+namespace simba {
+
+/**
+ * ReorderBuffer restores the 'msg_seq_num' order of packets captured from several taps or NIC queues.
+ * The buffer keeps a bounded window of preallocated frame slots indexed by 'msg_seq_num % window'.
+ *
+ *      next_seq
+ *         |
+ *   ... | H | B | . | B | B | . | ... |
+ *         | <------- window --------> |
+ *
+ * H - a hole, the packet with 'next_seq' is not received yet.
+ * B - buffered packets waiting for the hole to be filled.
+ *
+ * Packets are released in order. A hole is skipped only if one of the limits is exceeded:
+ *  - the oldest buffered packet waits longer than 'max_delay' nanoseconds of the capture time;
+ *  - 'max_depth' packets are buffered;
+ *  - a packet doesn't fit into the window.
+ *
+ * The buffered sequence numbers are also queued in the arrival order, the head of the queue is the oldest
+ * buffered packet. The released ones are popped from the head lazily, so the oldest one is found in O(1)
+ * amortized time. The queue holds 2 * window entries: the buffered packets and the released ones
+ * which arrived after the oldest buffered packet, both are fewer than the window.
+ *
+ * Packets which are behind 'next_seq' (duplicates or packets came after the hole has been skipped) are dropped.
+ **/
+class ReorderBuffer {
+
+	struct Slot {
+		pcap::Frame frame;
+		uint32_t seq;
+		bool used;
+	};
+
+public:
+
+	struct Stats {
+		uint64_t released;   // packets released in order
+		uint64_t reordered;  // packets which have been buffered
+		uint64_t dropped;    // duplicates and late packets
+		uint64_t skipped;    // sequence numbers skipped as holes
+		uint64_t flushes;    // how many times a hole has been skipped
+	};
+
+protected:
+	std::unique_ptr<Slot[]> _slots;
+	const uint32_t _mask;
+	const uint64_t _max_delay;
+	const size_t _max_depth;
+	std::unique_ptr<uint32_t[]> _arrivals; // The sequence numbers in the arrival order, 2 * window entries.
+	uint32_t _arrival_head;
+	uint32_t _arrival_tail;
+	uint32_t _next_seq;
+	size_t _buffered;
+	bool _synced;
+	Stats _stats;
+
+public:
+
+	ReorderBuffer(const ReorderBuffer&) = delete;
+	ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+
+	ReorderBuffer(ReorderBuffer&& rv) noexcept = delete;
+	ReorderBuffer& operator=(ReorderBuffer&& rv) = delete;
+
+	/**
+	 * @param window - the number of frame slots, rounded up to a power of two.
+	 * @param max_delay - the capture time in nanoseconds a hole might be waited for.
+	 * @param max_depth - a hole is skipped when @max_depth packets are buffered, at most @window.
+	 */
+	ReorderBuffer(size_t window, uint64_t max_delay, size_t max_depth) noexcept :
+		_slots(new Slot[round_up(window)]),
+		_mask(uint32_t(round_up(window) - 1u)),
+		_max_delay(max_delay),
+		_max_depth(max_depth < window ? max_depth : window),
+		_arrivals(new uint32_t[2u * round_up(window)]),
+		_arrival_head(0),
+		_arrival_tail(0),
+		_next_seq(0),
+		_buffered(0),
+		_synced(false),
+		_stats() {
+		for(size_t i = 0; i <= _mask; ++i) {
+			_slots[i].used = false;
+		}
+	}
+
+	/**
+	 * Push a packet into the buffer.
+	 * @param frame - a frame, the head points to the packet.
+	 * @param seq - the packet 'msg_seq_num'.
+	 * @param release - a callable 'void(pcap::Frame&)' which receives packets in order.
+	 */
+	template <typename Fn>
+	void push(pcap::Frame& frame, uint32_t seq, Fn&& release) noexcept {
+		if(not _synced) {
+			_next_seq = seq;
+			_synced = true;
+		}
+
+		const int32_t distance = int32_t(seq - _next_seq);
+		if(distance < 0) {
+			_stats.dropped++;
+
+		} else if(distance == 0) {
+			do_release(frame, release);
+			drain(release);
+
+		} else {
+			if(uint32_t(distance) > _mask) {
+				// The packet doesn't fit into the window.
+				flush_until(seq - _mask, release);
+			}
+
+			Slot& slot = _slots[seq & _mask];
+			if(slot.used) {
+				_stats.dropped++;
+			} else {
+				slot.frame.copy(frame);
+				slot.seq = seq;
+				slot.used = true;
+				if(_buffered == 0) {
+					_arrival_head = _arrival_tail;
+				}
+				_arrivals[_arrival_tail++ & (2u * _mask + 1u)] = seq;
+				_buffered++;
+				_stats.reordered++;
+				drain(release);
+			}
+		}
+
+		while(_buffered > 0 && limit_exceeded(frame.timestamp())) {
+			skip_hole(release);
+		}
+	}
+
+	/**
+	 * Release all the buffered packets in order skipping all the holes.
+	 * @param release - a callable 'void(pcap::Frame&)' which receives packets in order.
+	 */
+	template <typename Fn>
+	void flush(Fn&& release) noexcept {
+		while(_buffered > 0) {
+			skip_hole(release);
+		}
+	}
+
+	inline size_t buffered() const noexcept {
+		return _buffered;
+	}
+
+	inline const Stats& stats() const noexcept {
+		return _stats;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		fprintf(out, "ReorderBuffer [");
+		fprintf(out, " window=%u", _mask + 1u);
+		fprintf(out, " released=%lu", _stats.released);
+		fprintf(out, " reordered=%lu", _stats.reordered);
+		fprintf(out, " dropped=%lu", _stats.dropped);
+		fprintf(out, " skipped=%lu", _stats.skipped);
+		fprintf(out, " flushes=%lu", _stats.flushes);
+		fprintf(out, " ]\n");
+	}
+
+protected:
+
+	inline bool limit_exceeded(uint64_t now) noexcept {
+		if(_buffered >= _max_depth) {
+			return true;
+		}
+		const uint64_t since = oldest_timestamp();
+		return now > since && now - since > _max_delay;
+	}
+
+	template <typename Fn>
+	inline void do_release(pcap::Frame& frame, Fn& release) noexcept {
+		release(frame);
+		_next_seq++;
+		_stats.released++;
+	}
+
+	/**
+	 * Release the buffered packets which follow 'next_seq' without holes.
+	 */
+	template <typename Fn>
+	void drain(Fn& release) noexcept {
+		while(_buffered > 0) {
+			Slot& slot = _slots[_next_seq & _mask];
+			if(not slot.used || slot.seq != _next_seq) {
+				break;
+			}
+			slot.used = false;
+			_buffered--;
+			do_release(slot.frame, release);
+		}
+	}
+
+	/**
+	 * Skip the hole at 'next_seq' and release the packets which follow it.
+	 */
+	template <typename Fn>
+	void skip_hole(Fn& release) noexcept {
+		while(not _slots[_next_seq & _mask].used) {
+			_next_seq++;
+			_stats.skipped++;
+		}
+		_stats.flushes++;
+		drain(release);
+	}
+
+	/**
+	 * Release or skip everything before @seq.
+	 */
+	template <typename Fn>
+	void flush_until(uint32_t seq, Fn& release) noexcept {
+		while(int32_t(seq - _next_seq) > 0) {
+			Slot& slot = _slots[_next_seq & _mask];
+			if(slot.used) {
+				slot.used = false;
+				_buffered--;
+				do_release(slot.frame, release);
+			} else {
+				_next_seq++;
+				_stats.skipped++;
+			}
+		}
+		_stats.flushes++;
+		drain(release);
+	}
+
+	/**
+	 * @return The capture time of the oldest buffered packet, there MUST be one.
+	 */
+	inline uint64_t oldest_timestamp() noexcept {
+		while(true) {
+			const uint32_t seq = _arrivals[_arrival_head & (2u * _mask + 1u)];
+			const Slot& slot = _slots[seq & _mask];
+			if(slot.used && slot.seq == seq) {
+				return slot.frame.timestamp();
+			}
+			_arrival_head++;
+		}
+	}
+
+	static inline constexpr size_t round_up(size_t value) noexcept {
+		size_t result = 2u;
+		while(result < value) {
+			result <<= 1u;
+		}
+		return result;
+	}
+
+};
+
+}; // namespace simba
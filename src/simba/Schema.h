@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simba.h"
+
+namespace simba {
+
+/**
+ * The flat row schema of the messages shared by the export formats, the field names are stable.
+ * A row consists of two records: a message and its context (the packet level fields).
+ **/
+
+/**
+ * The packet level fields of a row.
+ */
+struct RowContext {
+	uint64_t sending_time;
+	uint32_t msg_seq_num;
+	int32_t security_id; // OrderBookSnapshotRoot::security_id
+	uint32_t rpt_seq;    // OrderBookSnapshotRoot::rpt_seq
+};
+
+enum class FieldKind : uint8_t {
+	Int,  // signed integer, a decimal if 'scale' is not zero
+	UInt, // unsigned integer
+	Char
+};
+
+enum FieldFlags : uint8_t {
+	FIELD_NULLABLE = 1u,
+	FIELD_KEY = 2u,      // the security key, e.g. might be dictionary encoded
+	FIELD_BITS = 4u      // a bit set, all the 64 bits are significant
+};
+
+struct Field {
+	enum class Source : uint8_t {
+		Message,
+		Context
+	};
+
+	const char* name;
+	uint8_t name_length;
+	Source source;
+	uint16_t offset;     // the value offset in the source record
+	FieldKind kind;
+	uint8_t width;       // bytes: 1, 2, 4 or 8
+	uint8_t scale;       // the number of the fraction digits of a decimal
+	uint8_t flags;       // FieldFlags
+	int64_t null_value;  // FIELD_NULLABLE only
+	uint64_t divisor;    // 10 ^ scale
+
+	/**
+	 * @return The address of the field of a row.
+	 */
+	inline const char* address(const void* message, const void* context) const noexcept {
+		return static_cast<const char*>(source == Source::Message ? message : context) + offset;
+	}
+
+	/**
+	 * @return The value of the field of a row, sign extended for FieldKind::Int.
+	 */
+	inline int64_t load(const void* message, const void* context) const noexcept {
+		const char* src = address(message, context);
+		switch(width) {
+			case 1u: {
+				uint8_t v;
+				memcpy(&v, src, sizeof(v));
+				return kind == FieldKind::Int ? int64_t(int8_t(v)) : int64_t(v);
+			}
+			case 2u: {
+				uint16_t v;
+				memcpy(&v, src, sizeof(v));
+				return kind == FieldKind::Int ? int64_t(int16_t(v)) : int64_t(v);
+			}
+			case 4u: {
+				uint32_t v;
+				memcpy(&v, src, sizeof(v));
+				return kind == FieldKind::Int ? int64_t(int32_t(v)) : int64_t(v);
+			}
+			default: {
+				int64_t v;
+				memcpy(&v, src, sizeof(v));
+				return v;
+			}
+		}
+	}
+
+	inline bool is_null(int64_t value) const noexcept {
+		return (flags & FIELD_NULLABLE) && value == null_value;
+	}
+};
+
+inline constexpr Field field(const char* name, Field::Source source, uint16_t offset, FieldKind kind, uint8_t width,
+                             uint8_t scale = 0, uint8_t flags = 0, int64_t null_value = 0) noexcept {
+	uint8_t length = 0;
+	while(name[length]) {
+		++length;
+	}
+	uint64_t divisor = 1u;
+	for(uint8_t i = 0; i < scale; ++i) {
+		divisor *= 10u;
+	}
+	return Field{name, length, source, offset, kind, width, scale, flags, null_value, divisor};
+}
+
+static constexpr int64_t INT64_NULL = INT64_MIN;
+static constexpr int64_t DECIMAL_NULL = INT64_MAX;
+
+static constexpr Field::Source MSG = Field::Source::Message;
+static constexpr Field::Source CTX = Field::Source::Context;
+
+static constexpr Field ORDER_UPDATE_FIELDS[] = {
+	field("sending_time", CTX, offsetof(RowContext, sending_time), FieldKind::UInt, 8),
+	field("msg_seq_num", CTX, offsetof(RowContext, msg_seq_num), FieldKind::UInt, 4),
+	field("md_entry_id", MSG, offsetof(OrderUpdate, md_entry_id), FieldKind::Int, 8),
+	field("md_entry_px", MSG, offsetof(OrderUpdate, md_entry_px), FieldKind::Int, 8, 5),
+	field("md_entry_size", MSG, offsetof(OrderUpdate, md_entry_size), FieldKind::Int, 8),
+	field("md_flags", MSG, offsetof(OrderUpdate, md_flags), FieldKind::UInt, 8, 0, FIELD_BITS),
+	field("security_id", MSG, offsetof(OrderUpdate, security_id), FieldKind::Int, 4, 0, FIELD_KEY),
+	field("rpt_seq", MSG, offsetof(OrderUpdate, rpt_seq), FieldKind::UInt, 4),
+	field("md_update_action", MSG, offsetof(OrderUpdate, md_update_action), FieldKind::UInt, 1),
+	field("md_entry_type", MSG, offsetof(OrderUpdate, md_entry_type), FieldKind::Char, 1),
+};
+
+static constexpr Field ORDER_EXECUTION_FIELDS[] = {
+	field("sending_time", CTX, offsetof(RowContext, sending_time), FieldKind::UInt, 8),
+	field("msg_seq_num", CTX, offsetof(RowContext, msg_seq_num), FieldKind::UInt, 4),
+	field("md_entry_id", MSG, offsetof(OrderExecution, md_entry_id), FieldKind::Int, 8),
+	field("md_entry_px", MSG, offsetof(OrderExecution, md_entry_px), FieldKind::Int, 8, 5, FIELD_NULLABLE,
+	      DECIMAL_NULL),
+	field("md_entry_size", MSG, offsetof(OrderExecution, md_entry_size), FieldKind::Int, 8, 0, FIELD_NULLABLE,
+	      INT64_NULL),
+	field("last_px", MSG, offsetof(OrderExecution, last_px), FieldKind::Int, 8, 5),
+	field("last_qty", MSG, offsetof(OrderExecution, last_qty), FieldKind::Int, 8),
+	field("trade_id", MSG, offsetof(OrderExecution, trade_id), FieldKind::Int, 8),
+	field("md_flags", MSG, offsetof(OrderExecution, md_flags), FieldKind::UInt, 8, 0, FIELD_BITS),
+	field("security_id", MSG, offsetof(OrderExecution, security_id), FieldKind::Int, 4, 0, FIELD_KEY),
+	field("rpt_seq", MSG, offsetof(OrderExecution, rpt_seq), FieldKind::UInt, 4),
+	field("md_update_action", MSG, offsetof(OrderExecution, md_update_action), FieldKind::UInt, 1),
+	field("md_entry_type", MSG, offsetof(OrderExecution, md_entry_type), FieldKind::Char, 1),
+};
+
+// OrderBookSnapshotEntry with the security and rpt_seq of its root.
+static constexpr Field SNAPSHOT_ENTRY_FIELDS[] = {
+	field("sending_time", CTX, offsetof(RowContext, sending_time), FieldKind::UInt, 8),
+	field("msg_seq_num", CTX, offsetof(RowContext, msg_seq_num), FieldKind::UInt, 4),
+	field("security_id", CTX, offsetof(RowContext, security_id), FieldKind::Int, 4, 0, FIELD_KEY),
+	field("rpt_seq", CTX, offsetof(RowContext, rpt_seq), FieldKind::UInt, 4),
+	field("md_entry_id", MSG, offsetof(OrderBookSnapshotEntry, md_entry_id), FieldKind::Int, 8, 0, FIELD_NULLABLE,
+	      INT64_NULL),
+	field("transact_time", MSG, offsetof(OrderBookSnapshotEntry, transact_time), FieldKind::UInt, 8),
+	field("md_entry_px", MSG, offsetof(OrderBookSnapshotEntry, md_entry_px), FieldKind::Int, 8, 5, FIELD_NULLABLE,
+	      DECIMAL_NULL),
+	field("md_entry_size", MSG, offsetof(OrderBookSnapshotEntry, md_entry_size), FieldKind::Int, 8, 0, FIELD_NULLABLE,
+	      INT64_NULL),
+	field("trade_id", MSG, offsetof(OrderBookSnapshotEntry, trade_id), FieldKind::Int, 8, 0, FIELD_NULLABLE,
+	      INT64_NULL),
+	field("md_flags", MSG, offsetof(OrderBookSnapshotEntry, md_flags), FieldKind::UInt, 8, 0, FIELD_BITS),
+	field("md_entry_type", MSG, offsetof(OrderBookSnapshotEntry, md_entry_type), FieldKind::Char, 1),
+};
+
+/**
+ * The exported tables.
+ */
+enum class Table : uint8_t {
+	OrderUpdate,
+	OrderExecution,
+	OrderBookSnapshot,
+	COUNT
+};
+
+struct TableSchema {
+	const char* name;
+	TemplateId template_id;
+	const Field* fields;
+	uint16_t count;
+};
+
+template <size_t N>
+inline constexpr TableSchema table_schema(const char* name, TemplateId tid, const Field (&fields)[N]) noexcept {
+	return TableSchema{name, tid, fields, uint16_t(N)};
+}
+
+static constexpr TableSchema TABLES[] = {
+	table_schema("OrderUpdate", TemplateId::OrderUpdate, ORDER_UPDATE_FIELDS),
+	table_schema("OrderExecution", TemplateId::OrderExecution, ORDER_EXECUTION_FIELDS),
+	table_schema("OrderBookSnapshot", TemplateId::OrderBookSnapshot, SNAPSHOT_ENTRY_FIELDS),
+};
+
+static_assert(sizeof(TABLES) / sizeof(TABLES[0]) == size_t(Table::COUNT), "TABLES");
+
+inline const TableSchema& table_schema(Table table) noexcept {
+	return TABLES[static_cast<uint8_t>(table)];
+}
+
+/**
+ * @return false - @name is not a table name.
+ */
+inline bool table_of(const char* name, size_t length, Table& table) noexcept {
+	for(uint8_t idx = 0; idx < uint8_t(Table::COUNT); ++idx) {
+		if(strlen(TABLES[idx].name) == length && memcmp(TABLES[idx].name, name, length) == 0) {
+			table = static_cast<Table>(idx);
+			return true;
+		}
+	}
+	return false;
+}
+
+}; // namespace simba
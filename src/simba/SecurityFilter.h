@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace simba {
+
+/**
+ * SecurityFilter is a set of security_id built as a perfect hash:
+ *
+ *   slot = (uint32_t(id) * multiplier) >> shift
+ *
+ * The multiplier is searched for at the build time so the ids don't collide, a lookup is a multiplication
+ * and a comparison of one slot. The table of a few dozen ids fits a couple of cache lines.
+ * The table is at most 8 slots per id. When no multiplier is found within it, the ids are kept in a bitset
+ * if their range is at most 256 bits per id and in an open addressing table of 2-4 slots per id otherwise.
+ * SimbaParser reads security_id of a message at its fixed offset and skips the message body if it is
+ * not accepted, nothing else is decoded and the handler is not called.
+ **/
+class SecurityFilter {
+
+	enum class Kind : uint8_t {
+		PerfectHash,
+		Bitset,
+		OpenAddressing,
+	};
+
+	static constexpr size_t MAX_ATTEMPTS = 4096u;  // the multipliers tried per table size
+	static constexpr size_t MAX_SLOTS_PER_ID = 8u; // the perfect hash table limit
+	static constexpr uint64_t MAX_BITS_PER_ID = 256u; // the bitset limit, the memory of 8 slots
+	static constexpr uint32_t MULTIPLIER = 0x9E3779B1u; // the open addressing hash
+
+	std::unique_ptr<int32_t[]> _slots;
+	std::unique_ptr<uint64_t[]> _bits; // the occupied slots or the bitset of 'id - _base'
+	Kind _kind;
+	uint32_t _multiplier;
+	uint32_t _shift;
+	uint32_t _mask;
+	int32_t _base;
+	uint64_t _range;
+	size_t _size;
+	uint64_t _accepted;
+	uint64_t _skipped;
+
+public:
+
+	SecurityFilter(const SecurityFilter&) = delete;
+	SecurityFilter& operator=(const SecurityFilter&) = delete;
+
+	SecurityFilter() noexcept :
+		_slots(),
+		_bits(),
+		_kind(Kind::PerfectHash),
+		_multiplier(0),
+		_shift(0),
+		_mask(0),
+		_base(0),
+		_range(0),
+		_size(0),
+		_accepted(0),
+		_skipped(0) {}
+
+	inline bool empty() const noexcept {
+		return _size == 0;
+	}
+
+	inline size_t size() const noexcept {
+		return _size;
+	}
+
+	/**
+	 * Build the filter of a comma separated list of security_id, e.g. "2304587,2304601".
+	 * @return false - the list is malformed.
+	 */
+	bool parse(const char* list) noexcept {
+		std::vector<int32_t> ids;
+		const char* pos = list;
+		while(*pos) {
+			char* end;
+			errno = 0;
+			const long id = strtol(pos, &end, 10);
+			if(end == pos || errno || id < INT32_MIN || id > INT32_MAX || (*end != ',' && *end != '\0')) {
+				fprintf(stderr, "Bad security_id list '%s'\n", list);
+				return false;
+			}
+			ids.push_back(int32_t(id));
+			pos = *end ? end + 1 : end;
+		}
+		if(ids.empty()) {
+			fprintf(stderr, "Bad security_id list '%s'\n", list);
+			return false;
+		}
+		build(ids);
+		return true;
+	}
+
+	/**
+	 * Build the filter of @ids, the duplicates are ignored.
+	 */
+	void build(std::vector<int32_t> ids) noexcept {
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+		_size = ids.size();
+
+		_kind = Kind::PerfectHash;
+		uint32_t bits = bits_for(ids.size() * 2u);
+		// A splitmix64 sequence of odd multipliers, the build is deterministic.
+		uint64_t state = 0;
+		for(; (size_t(1u) << bits) <= std::max<size_t>(16u, ids.size() * MAX_SLOTS_PER_ID); ++bits) {
+			reset(bits);
+			for(size_t attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
+				uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+				z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+				z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+				_multiplier = uint32_t(z ^ (z >> 31u)) | 1u;
+				if(place(ids)) {
+					return;
+				}
+			}
+		}
+
+		const uint64_t range = uint64_t(int64_t(ids.back()) - int64_t(ids.front())) + 1u;
+		if(range <= ids.size() * MAX_BITS_PER_ID) {
+			_kind = Kind::Bitset;
+			_base = ids.front();
+			_range = range;
+			_slots.reset();
+			_bits.reset(new uint64_t[(range + 63u) / 64u]());
+			for(const int32_t id : ids) {
+				const uint64_t offset = uint32_t(id) - uint32_t(_base);
+				_bits[offset / 64u] |= 1ull << (offset % 64u);
+			}
+			return;
+		}
+
+		_kind = Kind::OpenAddressing;
+		_multiplier = MULTIPLIER;
+		reset(bits_for(ids.size() * 2u));
+		for(const int32_t id : ids) {
+			uint32_t idx = slot(id);
+			while(occupied(idx)) {
+				idx = (idx + 1u) & _mask;
+			}
+			occupy(idx, id);
+		}
+	}
+
+	/**
+	 * @return true - @id is in the set.
+	 */
+	inline bool accept(int32_t id) noexcept {
+		bool result;
+		if(__builtin_expect(_kind == Kind::PerfectHash, 1)) {
+			const uint32_t idx = slot(id);
+			result = occupied(idx) && _slots[idx] == id;
+		} else if(_kind == Kind::Bitset) {
+			const uint64_t offset = uint32_t(id) - uint32_t(_base);
+			result = offset < _range && ((_bits[offset / 64u] >> (offset % 64u)) & 1u);
+		} else {
+			uint32_t idx = slot(id);
+			while(occupied(idx) && _slots[idx] != id) {
+				idx = (idx + 1u) & _mask;
+			}
+			result = occupied(idx);
+		}
+		_accepted += result;
+		_skipped += not result;
+		return result;
+	}
+
+	void dump_stats(FILE* out) const noexcept {
+		static constexpr const char* KINDS[] = {"perfect_hash", "bitset", "open_addressing"};
+		const size_t slots = _kind == Kind::Bitset ? size_t(_range) : _slots ? size_t(_mask) + 1u : 0u;
+		fprintf(out, "SecurityFilter [ securities=%zu kind=%s %s=%zu accepted=%lu skipped=%lu ]\n", _size,
+		        KINDS[uint8_t(_kind)], _kind == Kind::Bitset ? "bits" : "slots", slots, _accepted, _skipped);
+	}
+
+protected:
+
+	static inline uint32_t bits_for(size_t slots) noexcept {
+		uint32_t bits = 4u;
+		while((size_t(1u) << bits) < slots) {
+			bits++;
+		}
+		return bits;
+	}
+
+	inline uint32_t slot(int32_t id) const noexcept {
+		return (uint32_t(id) * _multiplier) >> _shift;
+	}
+
+	inline bool occupied(uint32_t idx) const noexcept {
+		return (_bits[idx / 64u] >> (idx % 64u)) & 1u;
+	}
+
+	inline void occupy(uint32_t idx, int32_t id) noexcept {
+		_bits[idx / 64u] |= 1ull << (idx % 64u);
+		_slots[idx] = id;
+	}
+
+	/**
+	 * Allocate an empty table of '1 << bits' slots.
+	 */
+	void reset(uint32_t bits) noexcept {
+		const size_t slots = size_t(1u) << bits;
+		_slots.reset(new int32_t[slots]);
+		_bits.reset(new uint64_t[(slots + 63u) / 64u]());
+		_shift = 32u - bits;
+		_mask = uint32_t(slots - 1u);
+	}
+
+	/**
+	 * @return false - two ids collide with the current multiplier.
+	 */
+	bool place(const std::vector<int32_t>& ids) noexcept {
+		std::fill(_bits.get(), _bits.get() + (size_t(_mask) + 64u) / 64u, 0u);
+		for(const int32_t id : ids) {
+			const uint32_t idx = slot(id);
+			if(occupied(idx)) {
+				return false;
+			}
+			occupy(idx, id);
+		}
+		return true;
+	}
+
+};
+
+}; // namespace simba
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__) && __BYTE_ORDER == __LITTLE_ENDIAN
+#include <emmintrin.h>
+#endif
+
+#include "simba.h"
+
+namespace simba {
+
+/**
+ * SnapshotColumns is the OrderBookSnapshotEntry group of a message transposed into the columns:
+ *
+ *   md_entry_id[0..count) transact_time[0..count) ... md_entry_type[0..count) orders[0..count)
+ *
+ * The packed entries are transposed two at a time with the SSE2 unpacks, the null md_entry_id, md_entry_px and
+ * md_entry_size are detected by the same vector compares, 'orders[i]' is 1 when none of them is null.
+ * A handler declares SNAPSHOT_COLUMNS to receive the group by one on_snapshot_columns() call.
+ **/
+struct SnapshotColumns {
+	static constexpr size_t CAPACITY = 256u; // GroupSize::num_in_group is uInt8
+
+	size_t count;
+	int64_t md_entry_id[CAPACITY];
+	uint64_t transact_time[CAPACITY];
+	int64_t md_entry_px[CAPACITY];
+	int64_t md_entry_size[CAPACITY];
+	int64_t trade_id[CAPACITY];
+	uint64_t md_flags[CAPACITY];
+	MDEntryType md_entry_type[CAPACITY];
+	uint8_t orders[CAPACITY];
+
+	/**
+	 * Transpose @count entries of the group, the group length has been validated.
+	 */
+	void decode(const uint8_t* group, size_t count) noexcept {
+		static_assert(sizeof(OrderBookSnapshotEntry) == 49u, "the SIMBA layout of OrderBookSnapshotEntry");
+		constexpr size_t STRIDE = sizeof(OrderBookSnapshotEntry);
+		this->count = count;
+		size_t idx = 0;
+
+#if defined(__SSE2__) && __BYTE_ORDER == __LITTLE_ENDIAN
+		const __m128i id_null = _mm_set1_epi64x(INT64_MIN);
+		const __m128i px_null = _mm_set1_epi64x(INT64_MAX);
+		for(; idx + 2u <= count; idx += 2u) {
+			const uint8_t* a = group + idx * STRIDE;
+			const uint8_t* b = a + STRIDE;
+			// md_entry_id transact_time | md_entry_px md_entry_size | trade_id md_flags
+			const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+			const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 16u));
+			const __m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 32u));
+			const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+			const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 16u));
+			const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 32u));
+
+			const __m128i id = _mm_unpacklo_epi64(a0, b0);
+			const __m128i px = _mm_unpacklo_epi64(a1, b1);
+			const __m128i size = _mm_unpackhi_epi64(a1, b1);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(md_entry_id + idx), id);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(transact_time + idx), _mm_unpackhi_epi64(a0, b0));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(md_entry_px + idx), px);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(md_entry_size + idx), size);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(trade_id + idx), _mm_unpacklo_epi64(a2, b2));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(md_flags + idx), _mm_unpackhi_epi64(a2, b2));
+			md_entry_type[idx] = MDEntryType(a[48]);
+			md_entry_type[idx + 1u] = MDEntryType(b[48]);
+
+			const __m128i nulls = _mm_or_si128(_mm_or_si128(equal(id, id_null), equal(px, px_null)),
+			                                   equal(size, id_null));
+			const int mask = _mm_movemask_pd(_mm_castsi128_pd(nulls));
+			orders[idx] = uint8_t(not (mask & 1));
+			orders[idx + 1u] = uint8_t(not (mask & 2));
+		}
+#endif
+
+		for(; idx < count; ++idx) {
+			OrderBookSnapshotEntry entry;
+			memcpy(&entry, group + idx * STRIDE, STRIDE);
+#if __BYTE_ORDER == __BIG_ENDIAN
+			entry.swap_endian();
+#endif
+			md_entry_id[idx] = entry.md_entry_id._value;
+			transact_time[idx] = entry.transact_time;
+			md_entry_px[idx] = entry.md_entry_px._value;
+			md_entry_size[idx] = entry.md_entry_size._value;
+			trade_id[idx] = entry.trade_id._value;
+			md_flags[idx] = entry.md_flags;
+			md_entry_type[idx] = entry.md_entry_type;
+			orders[idx] = uint8_t(not entry.md_entry_id.is_null() && not entry.md_entry_px.is_null()
+			                      && not entry.md_entry_size.is_null());
+		}
+	}
+
+protected:
+
+#if defined(__SSE2__) && __BYTE_ORDER == __LITTLE_ENDIAN
+	/**
+	 * The 64-bit lanes compare of SSE2: both 32-bit halves are equal.
+	 */
+	static inline __m128i equal(__m128i a, __m128i b) noexcept {
+		const __m128i halves = _mm_cmpeq_epi32(a, b);
+		return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+#endif
+
+};
+
+}; // namespace simba
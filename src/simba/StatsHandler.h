@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "../book/SecurityMap.h"
+
+#include "Handler.h"
+
+namespace simba {
+
+/**
+ * StatsHandler only counts the decoded messages, nothing is formatted until dump().
+ * Every counter is a slot of a flat array indexed by the raw enum value,
+ * so a message costs a few increments. The dropped frames are counted by ErrorLog.
+ **/
+class StatsHandler : public Handler {
+public:
+
+	static constexpr size_t TEMPLATES = 1024u; // the template ids above are counted as 'other'
+	static constexpr size_t FLAG_BITS = sizeof(MDFlagsSet) * 8u;
+
+protected:
+
+	struct SecurityCounters {
+		int32_t id;
+		uint64_t updates;
+		uint64_t executions;
+		uint64_t entries;
+	};
+
+	uint64_t _packets;
+	uint64_t _incremental;
+	uint64_t _templates[TEMPLATES + 1u];
+	uint64_t _actions[256];
+	uint64_t _entry_types[256];
+	uint64_t _flags[FLAG_BITS];
+	book::SecurityMap _securities;
+	std::vector<SecurityCounters> _counters; // the dense index of a security -> the counters
+	uint32_t _snapshot;                      // the dense index of the current snapshot security
+
+public:
+
+	StatsHandler() noexcept :
+		_packets(0),
+		_incremental(0),
+		_templates(),
+		_actions(),
+		_entry_types(),
+		_flags(),
+		_securities(),
+		_counters(),
+		_snapshot(0) {}
+
+	// simba::Handler
+
+	inline void on_packet_header(const MarketDataPacketHeader& header) noexcept {
+		_packets++;
+		_incremental += header.has_flag(MarketDataPacketHeader::Flags::IncrementalPacket);
+	}
+
+	inline void on_message_header(const SBEMessageHeader& header) noexcept {
+		const size_t id = static_cast<uint16_t>(header.template_id);
+		_templates[id < TEMPLATES ? id : TEMPLATES]++;
+	}
+
+	inline void on_order_update(const OrderUpdate& msg) noexcept {
+		_actions[static_cast<uint8_t>(msg.md_update_action)]++;
+		_entry_types[static_cast<uint8_t>(msg.md_entry_type)]++;
+		count_flags(msg.md_flags);
+		_counters[security(msg.security_id)].updates++;
+	}
+
+	inline void on_order_execution(const OrderExecution& msg) noexcept {
+		_actions[static_cast<uint8_t>(msg.md_update_action)]++;
+		_entry_types[static_cast<uint8_t>(msg.md_entry_type)]++;
+		count_flags(msg.md_flags);
+		_counters[security(msg.security_id)].executions++;
+	}
+
+	inline void on_snapshot_root(const OrderBookSnapshotRoot& msg) noexcept {
+		_snapshot = security(int32_t(msg.security_id));
+	}
+
+	inline void on_snapshot_entry(const OrderBookSnapshotEntry& entry) noexcept {
+		_entry_types[static_cast<uint8_t>(entry.md_entry_type)]++;
+		count_flags(entry.md_flags);
+		_counters[_snapshot].entries++;
+	}
+
+	/**
+	 * Print the summary tables, the zero counters are omitted.
+	 */
+	void dump(FILE* out) const noexcept {
+		fprintf(out, "Packets [ total=%lu incremental=%lu snapshot=%lu ]\n", _packets, _incremental,
+		        _packets - _incremental);
+
+		fprintf(out, "TemplateId\n");
+		for(size_t id = 0; id < TEMPLATES; ++id) {
+			if(_templates[id]) {
+				fprintf(out, "  %-5zu %-30s %12lu\n", id, template_id_name(static_cast<TemplateId>(id)), _templates[id]);
+			}
+		}
+		if(_templates[TEMPLATES]) {
+			fprintf(out, "  %-5s %-30s %12lu\n", "-", "other", _templates[TEMPLATES]);
+		}
+
+		fprintf(out, "MDUpdateAction\n");
+		for(size_t id = 0; id < 256u; ++id) {
+			if(_actions[id]) {
+				fprintf(out, "  %-5zu %-30s %12lu\n", id, md_update_action_name(static_cast<MDUpdateAction>(id)), _actions[id]);
+			}
+		}
+
+		fprintf(out, "MDEntryType\n");
+		for(size_t id = 0; id < 256u; ++id) {
+			if(_entry_types[id]) {
+				fprintf(out, "  %-5zu %-30s %12lu\n", id, md_entry_type_name(MDEntryType(id)), _entry_types[id]);
+			}
+		}
+
+		fprintf(out, "MDFlagsBits\n");
+		for(size_t bit = 0; bit < FLAG_BITS; ++bit) {
+			if(_flags[bit]) {
+				fprintf(out, "  %-5zu %-30s %12lu\n", bit, md_flag_bits_name(static_cast<MDFlagsBits>(bit)), _flags[bit]);
+			}
+		}
+
+		std::vector<SecurityCounters> securities(_counters);
+		std::sort(securities.begin(), securities.end(), [](const SecurityCounters& a, const SecurityCounters& b) {
+			return a.id < b.id;
+		});
+		fprintf(out, "Securities [ count=%zu ]\n", securities.size());
+		fprintf(out, "  %-12s %12s %12s %12s\n", "security_id", "updates", "executions", "entries");
+		for(const SecurityCounters& sec : securities) {
+			fprintf(out, "  %-12d %12lu %12lu %12lu\n", sec.id, sec.updates, sec.executions, sec.entries);
+		}
+	}
+
+protected:
+
+	inline void count_flags(MDFlagsSet flags) noexcept {
+		while(flags) {
+			_flags[__builtin_ctzll(flags)]++;
+			flags &= flags - 1u;
+		}
+	}
+
+	/**
+	 * @return The dense index of the security counters.
+	 */
+	inline uint32_t security(int32_t id) noexcept {
+		const uint32_t idx = _securities.insert(id);
+		if(idx == _counters.size()) {
+			_counters.push_back(SecurityCounters{id, 0, 0, 0});
+		}
+		return idx;
+	}
+
+};
+
+}; // namespace simba
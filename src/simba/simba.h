@@ -37,24 +37,34 @@ struct MarketDataPacketHeader {
 		sending_time = __builtin_bswap64(sending_time);
 	}
 
-	void dump(FILE* out) const noexcept {
-		fprintf(out, "MarketDataPacketHeader [");
-		fprintf(out, " msg_seq_num=%u", msg_seq_num);
-		fprintf(out, " msg_size=%u", msg_size);
-		fprintf(out, " msg_flags=0x%x", msg_flags);
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("MarketDataPacketHeader [");
+		out.append(" msg_seq_num=").append_uint(msg_seq_num);
+		out.append(" msg_size=").append_uint(msg_size);
+		out.append(" msg_flags=0x").append_hex(msg_flags);
 
 		if(msg_flags) {
-			fprintf(out, "(");
-			fprintf(out, "%s", has_flag(Flags::LastFragment) ? " LastFragment" : "");
-			fprintf(out, "%s", has_flag(Flags::StartOfSnapshot) ? " StartOfSnapshot" : "");
-			fprintf(out, "%s", has_flag(Flags::EndOfSnapshot) ? " EndOfSnapshot" : "");
-			fprintf(out, "%s", has_flag(Flags::IncrementalPacket) ? " IncrementalPacket" : "");
-			fprintf(out, "%s", has_flag(Flags::PossDupFlag) ? " PossDupFlag" : "");
-			fprintf(out, " )");
+			out.append("(");
+			if(has_flag(Flags::LastFragment)) {
+				out.append(" LastFragment");
+			}
+			if(has_flag(Flags::StartOfSnapshot)) {
+				out.append(" StartOfSnapshot");
+			}
+			if(has_flag(Flags::EndOfSnapshot)) {
+				out.append(" EndOfSnapshot");
+			}
+			if(has_flag(Flags::IncrementalPacket)) {
+				out.append(" IncrementalPacket");
+			}
+			if(has_flag(Flags::PossDupFlag)) {
+				out.append(" PossDupFlag");
+			}
+			out.append(" )");
 		}
 
-		fprintf(out, " sending_time=0x%zu", sending_time);
-		fprintf(out, " ]\n");
+		out.append(" sending_time=0x").append_uint(sending_time);
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -72,11 +82,11 @@ struct IncrementalHeader {
 		exchange_trading_session_id = __builtin_bswap32(exchange_trading_session_id);
 	}
 
-	void dump(FILE* out) noexcept {
-		fprintf(out, "IncrementalHeader [");
-		fprintf(out, " transact_time=%zu", transact_time);
-		fprintf(out, " exchange_trading_session_id=0x%u", exchange_trading_session_id);
-		fprintf(out, "]\n");
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("IncrementalHeader [");
+		out.append(" transact_time=").append_uint(transact_time);
+		out.append(" exchange_trading_session_id=0x").append_uint(exchange_trading_session_id);
+		out.append("]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -98,13 +108,118 @@ struct SBEMessageHeader {
 		version = __builtin_bswap16(version);
 	}
 
-	void dump(FILE* out) const noexcept {
-		fprintf(out, "SBEMessage [");
-		fprintf(out, " block_length=%u", block_length);
-		fprintf(out, " template_id='%s'(%u)", template_id_name(template_id), static_cast<uint16_t>(template_id));
-		fprintf(out, " schema_id='%s'(%u)", schema_id_name(schema_id), static_cast<uint16_t>(schema_id));
-		fprintf(out, " version=%u", version);
-		fprintf(out, " ]\n");
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("SBEMessage [");
+		out.append(" block_length=").append_uint(block_length);
+		out.append(" template_id='").append_str(template_id_name(template_id));
+		out.append("'(").append_uint(static_cast<uint16_t>(template_id)).append(")");
+		out.append(" schema_id='").append_str(schema_id_name(schema_id));
+		out.append("'(").append_uint(static_cast<uint16_t>(schema_id)).append(")");
+		out.append(" version=").append_uint(version);
+		out.append(" ]\n");
+	}
+
+} __attribute__ ((__packed__));
+
+
+//===================================
+// EmptyBook (msg id=4)
+//===================================
+struct EmptyBook {
+	uInt32 last_msg_seq_num_processed;
+
+	void swap_endian() noexcept {
+		last_msg_seq_num_processed = __builtin_bswap32(last_msg_seq_num_processed);
+	}
+
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("EmptyBook [");
+		out.append(" last_msg_seq_num_processed=").append_uint(last_msg_seq_num_processed);
+		out.append(" ]\n");
+	}
+
+} __attribute__ ((__packed__));
+
+
+//===================================
+// SecurityStatus (msg id=9)
+//===================================
+struct SecurityStatus {
+	Int32 security_id;
+	char symbol[25];
+	SecurityTradingStatus security_trading_status;
+	Decimal5Null high_limit_px;
+	Decimal5Null low_limit_px;
+	Decimal2Null initial_margin_on_buy;
+	Decimal2Null initial_margin_on_sell;
+	Decimal2Null initial_margin_syntetic;
+
+	void swap_endian() noexcept {
+		security_id = __builtin_bswap32(security_id);
+		high_limit_px._value = __builtin_bswap64(high_limit_px._value);
+		low_limit_px._value = __builtin_bswap64(low_limit_px._value);
+		initial_margin_on_buy._value = __builtin_bswap64(initial_margin_on_buy._value);
+		initial_margin_on_sell._value = __builtin_bswap64(initial_margin_on_sell._value);
+		initial_margin_syntetic._value = __builtin_bswap64(initial_margin_syntetic._value);
+	}
+
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("SecurityStatus [");
+		out.append(" security_id=").append_int(security_id);
+		out.append(" symbol='").append(symbol, strnlen(symbol, sizeof(symbol))).append("'");
+		out.append(" security_trading_status=").append_str(security_trading_status_name(security_trading_status));
+		out.append(" high_limit_px=");
+		dump_nullable(out, high_limit_px);
+		out.append(" low_limit_px=");
+		dump_nullable(out, low_limit_px);
+		out.append(" initial_margin_on_buy=");
+		dump_nullable(out, initial_margin_on_buy);
+		out.append(" initial_margin_on_sell=");
+		dump_nullable(out, initial_margin_on_sell);
+		out.append(" initial_margin_syntetic=");
+		dump_nullable(out, initial_margin_syntetic);
+		out.append(" ]\n");
+	}
+
+} __attribute__ ((__packed__));
+
+
+//===================================
+// TradingSessionStatus (msg id=11)
+//===================================
+struct TradingSessionStatus {
+	uInt64 trad_ses_open_time;
+	uInt64 trad_ses_close_time;
+	uInt64Null trad_ses_interm_clearing_start_time;
+	uInt64Null trad_ses_interm_clearing_end_time;
+	Int32 trading_session_id;
+	Int32Null exchange_trading_session_id;
+	TradSesStatus trad_ses_status;
+	char market_segment_id;
+	uInt8 trad_ses_event;
+
+	void swap_endian() noexcept {
+		trad_ses_open_time = __builtin_bswap64(trad_ses_open_time);
+		trad_ses_close_time = __builtin_bswap64(trad_ses_close_time);
+		trad_ses_interm_clearing_start_time = __builtin_bswap64(trad_ses_interm_clearing_start_time);
+		trad_ses_interm_clearing_end_time = __builtin_bswap64(trad_ses_interm_clearing_end_time);
+		trading_session_id = __builtin_bswap32(trading_session_id);
+		exchange_trading_session_id._value = __builtin_bswap32(exchange_trading_session_id._value);
+	}
+
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("TradingSessionStatus [");
+		out.append(" trad_ses_open_time=").append_uint(trad_ses_open_time);
+		out.append(" trad_ses_close_time=").append_uint(trad_ses_close_time);
+		out.append(" trad_ses_interm_clearing_start_time=").append_uint(trad_ses_interm_clearing_start_time);
+		out.append(" trad_ses_interm_clearing_end_time=").append_uint(trad_ses_interm_clearing_end_time);
+		out.append(" trading_session_id=").append_int(trading_session_id);
+		out.append(" exchange_trading_session_id=");
+		dump_nullable(out, exchange_trading_session_id);
+		out.append(" trad_ses_status=").append_str(trad_ses_status_name(trad_ses_status));
+		out.append(" market_segment_id='").append_char(market_segment_id).append("'");
+		out.append(" trad_ses_event=").append_uint(trad_ses_event);
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -132,24 +247,24 @@ struct OrderUpdate {
 		rpt_seq = __builtin_bswap16(rpt_seq);
 	}
 
-	void dump(FILE* out) noexcept {
-		fprintf(out, "OrderUpdate [");
-		fprintf(out, " md_entry_id=%zd", md_entry_id);
-		fprintf(out, " md_entry_px=%f", md_entry_px.get());
-		fprintf(out, " md_entry_size=%zd", md_entry_size);
-		fprintf(out, " md_flags=0x%zx", md_flags);
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("OrderUpdate [");
+		out.append(" md_entry_id=").append_int(md_entry_id);
+		out.append(" md_entry_px=").append_fixed(md_entry_px._value, Decimal5::DIVISOR);
+		out.append(" md_entry_size=").append_int(md_entry_size);
+		out.append(" md_flags=0x").append_hex(md_flags);
 
 		if(md_flags) {
-			fprintf(out, "(");
+			out.append("(");
 			dump_md_flag_bits(out, md_flags);
-			fprintf(out, " )");
+			out.append(" )");
 		}
 
-		fprintf(out, " md_entry_size=%d", security_id);
-		fprintf(out, " rpt_seq=%u", rpt_seq);
-		fprintf(out, " md_entry_type='%s'", md_update_action_name(md_update_action));
-		fprintf(out, " md_entry_type='%s'", md_entry_type_name(md_entry_type));
-		fprintf(out, " ]\n");
+		out.append(" md_entry_size=").append_int(security_id);
+		out.append(" rpt_seq=").append_uint(rpt_seq);
+		out.append(" md_entry_type='").append_str(md_update_action_name(md_update_action)).append("'");
+		out.append(" md_entry_type='").append_str(md_entry_type_name(md_entry_type)).append("'");
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -183,27 +298,29 @@ struct OrderExecution {
 		rpt_seq = __builtin_bswap32(rpt_seq);
 	}
 
-	void dump(FILE* out) noexcept {
-		fprintf(out, "OrderExecution [");
-		fprintf(out, " md_entry_id=%zd", md_entry_id);
-		fprintf(out, " md_entry_px=%s", md_entry_px.to_string().c_str());
-		fprintf(out, " md_entry_size=%s", md_entry_size.to_string().c_str());
-		fprintf(out, " last_px=%f", last_px.get());
-		fprintf(out, " last_qty=%zd", last_qty);
-		fprintf(out, " trade_id=%zd", trade_id);
-		fprintf(out, " md_flags=0x%zx", md_flags);
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("OrderExecution [");
+		out.append(" md_entry_id=").append_int(md_entry_id);
+		out.append(" md_entry_px=");
+		dump_nullable(out, md_entry_px);
+		out.append(" md_entry_size=");
+		dump_nullable(out, md_entry_size);
+		out.append(" last_px=").append_fixed(last_px._value, Decimal5::DIVISOR);
+		out.append(" last_qty=").append_int(last_qty);
+		out.append(" trade_id=").append_int(trade_id);
+		out.append(" md_flags=0x").append_hex(md_flags);
 
 		if(md_flags) {
-			fprintf(out, "(");
+			out.append("(");
 			dump_md_flag_bits(out, md_flags);
-			fprintf(out, " )");
+			out.append(" )");
 		}
 
-		fprintf(out, " md_entry_size=%d", security_id);
-		fprintf(out, " rpt_seq=%u", rpt_seq);
-		fprintf(out, " md_entry_type='%s'", md_update_action_name(md_update_action));
-		fprintf(out, " md_entry_type='%s'", md_entry_type_name(md_entry_type));
-		fprintf(out, " ]\n");
+		out.append(" md_entry_size=").append_int(security_id);
+		out.append(" rpt_seq=").append_uint(rpt_seq);
+		out.append(" md_entry_type='").append_str(md_update_action_name(md_update_action)).append("'");
+		out.append(" md_entry_type='").append_str(md_entry_type_name(md_entry_type)).append("'");
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -225,13 +342,13 @@ struct OrderBookSnapshotRoot {
 		exchange_trading_session_id = __builtin_bswap32(exchange_trading_session_id);
 	}
 
-	void dump(FILE* out) noexcept {
-		fprintf(out, "OrderBookSnapshotRoot [");
-		fprintf(out, " security_id=%u", security_id);
-		fprintf(out, " last_msg_seq_sum_processed=%u", last_msg_seq_sum_processed);
-		fprintf(out, " rpt_seq=%u", rpt_seq);
-		fprintf(out, " exchange_trading_session_id=%u", exchange_trading_session_id);
-		fprintf(out, " ]\n");
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("OrderBookSnapshotRoot [");
+		out.append(" security_id=").append_uint(security_id);
+		out.append(" last_msg_seq_sum_processed=").append_uint(last_msg_seq_sum_processed);
+		out.append(" rpt_seq=").append_uint(rpt_seq);
+		out.append(" exchange_trading_session_id=").append_uint(exchange_trading_session_id);
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -245,11 +362,11 @@ struct GroupSize {
 		block_length = __builtin_bswap16(block_length);
 	}
 
-	void dump(FILE* out) noexcept {
-		fprintf(out, "GroupSize [");
-		fprintf(out, " block_ength=%u", block_length);
-		fprintf(out, " num_in_group=%u", num_in_group);
-		fprintf(out, " ]\n");
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("GroupSize [");
+		out.append(" block_ength=").append_uint(block_length);
+		out.append(" num_in_group=").append_uint(num_in_group);
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
@@ -273,23 +390,27 @@ struct OrderBookSnapshotEntry {
 		md_flags = __builtin_bswap64(md_flags);
 	}
 
-	void dump(FILE* out) noexcept {
-		fprintf(out, "OrderBookSnapshotEntry [");
-		fprintf(out, " md_entry_id=%s", md_entry_id.to_string().c_str());
-		fprintf(out, " transact_time=%zu", transact_time);
-		fprintf(out, " md_entry_px=%s", md_entry_px.to_string().c_str());
-		fprintf(out, " md_entry_size=%s", md_entry_size.to_string().c_str());
-		fprintf(out, " trade_id=%s", trade_id.to_string().c_str());
-		fprintf(out, " md_flags=0x%zx", md_flags);
+	void dump(output::TextBuffer& out) const noexcept {
+		out.append("OrderBookSnapshotEntry [");
+		out.append(" md_entry_id=");
+		dump_nullable(out, md_entry_id);
+		out.append(" transact_time=").append_uint(transact_time);
+		out.append(" md_entry_px=");
+		dump_nullable(out, md_entry_px);
+		out.append(" md_entry_size=");
+		dump_nullable(out, md_entry_size);
+		out.append(" trade_id=");
+		dump_nullable(out, trade_id);
+		out.append(" md_flags=0x").append_hex(md_flags);
 
 		if(md_flags) {
-			fprintf(out, "(");
+			out.append("(");
 			dump_md_flag_bits(out, md_flags);
-			fprintf(out, " )");
+			out.append(" )");
 		}
 
-		fprintf(out, " md_entry_type='%s'", md_entry_type_name(md_entry_type));
-		fprintf(out, " ]\n");
+		out.append(" md_entry_type='").append_str(md_entry_type_name(md_entry_type)).append("'");
+		out.append(" ]\n");
 	}
 
 } __attribute__ ((__packed__));
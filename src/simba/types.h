@@ -2,11 +2,20 @@
 
 #include <cstdint>
 #include <cstdio>
-#include <string>
-#include <cmath>
+#include <cstring>
+
+#include "../output/Format.h"
+#include "../output/TextBuffer.h"
 
 namespace simba {
 
+/**
+ * The nullable integers format themselves without allocations: to_chars() writes the text to a caller buffer
+ * of at least output::FORMAT_MAX bytes and returns the pointer past the last written character.
+ * The decimals are printed exactly from the scaled integer by TextBuffer::append_decimal(),
+ * e.g. Decimal5{12345} is "0.12345".
+ **/
+
 template <typename T, T NullValue>
 struct IntNull {
 	T _value;
@@ -15,16 +24,25 @@ struct IntNull {
 		return _value == NullValue;
 	}
 
-	inline std::string to_string() const noexcept {
-		return is_null() ? "'null'" : std::to_string(_value);
+	inline char* to_chars(char* ptr) const noexcept {
+		if(is_null()) {
+			memcpy(ptr, "'null'", 6u);
+			return ptr + 6u;
+		}
+		return output::format_int(ptr, _value);
 	}
 
 } __attribute__ ((__packed__));
 
 template <typename T, T div>
 struct Decimal {
+	static constexpr T DIVISOR = div;
+
 	T _value;
 
+	/**
+	 * The approximate value, use '_value' and DIVISOR where exactness matters.
+	 */
 	inline double get() const noexcept {
 		return double(_value) / div;
 	}
@@ -33,8 +51,13 @@ struct Decimal {
 
 template <typename T, T NullValue, T div>
 struct DecimalNull {
+	static constexpr T DIVISOR = div;
+
 	T _value;
 
+	/**
+	 * The approximate value, use '_value' and DIVISOR where exactness matters.
+	 */
 	inline double get() const noexcept {
 		return double(_value) / div;
 	}
@@ -43,12 +66,25 @@ struct DecimalNull {
 		return _value == NullValue;
 	}
 
-	inline std::string to_string() const noexcept {
-		return is_null() ? "'null'" : std::to_string(get());
-	}
-
 } __attribute__ ((__packed__));
 
+template <typename T, T NullValue>
+inline void dump_nullable(output::TextBuffer& out, const IntNull<T, NullValue>& value) noexcept {
+	out.append_value(value);
+}
+
+/**
+ * The dump keeps the "%f" text of the decimals, see TextBuffer::append_fixed().
+ */
+template <typename T, T NullValue, T div>
+inline void dump_nullable(output::TextBuffer& out, const DecimalNull<T, NullValue, div>& value) noexcept {
+	if(value.is_null()) {
+		out.append("'null'");
+	} else {
+		out.append_fixed(value._value, div);
+	}
+}
+
 using uInt8 = uint8_t;
 using uInt16 = uint16_t;
 using uInt32 = uint32_t;
@@ -128,12 +164,35 @@ const char* md_flag_bits_name(const MDFlagsBits& bits) noexcept {
 	}
 }
 
-void dump_md_flag_bits(FILE* out, const MDFlagsSet& flags) noexcept {
-	for(uint8_t bit = 0; bit < sizeof(MDFlagsSet) * 8u; ++bit) {
-		const MDFlagsSet mask = 1ull << bit;
-		if(flags & mask) {
-			fprintf(out, " %s", md_flag_bits_name(static_cast<MDFlagsBits>(bit)));
+/**
+ * The flag names prefixed with a space, indexed by the bit number.
+ */
+struct MDFlagName {
+	char text[32];
+	size_t length;
+};
+
+inline const MDFlagName* md_flag_bits_table() noexcept {
+	static const struct Table {
+		MDFlagName names[sizeof(MDFlagsSet) * 8u];
+
+		Table() noexcept : names() {
+			for(uint8_t bit = 0; bit < sizeof(MDFlagsSet) * 8u; ++bit) {
+				const int length = snprintf(names[bit].text, sizeof(names[bit].text), " %s",
+				                            md_flag_bits_name(static_cast<MDFlagsBits>(bit)));
+				names[bit].length = size_t(length);
+			}
 		}
+	} table;
+	return table.names;
+}
+
+void dump_md_flag_bits(output::TextBuffer& out, MDFlagsSet flags) noexcept {
+	const MDFlagName* names = md_flag_bits_table();
+	while(flags) {
+		const MDFlagName& name = names[__builtin_ctzll(flags)];
+		flags &= flags - 1u;
+		out.append(name.text, name.length);
 	}
 }
 
@@ -153,6 +212,56 @@ const char* md_update_action_name(const MDUpdateAction& id) noexcept {
 	}
 }
 
+enum class TradSesStatus : uint8_t {
+	Halted = 1u,
+	Open = 2u,
+	Closed = 3u,
+	PreOpen = 4u
+};
+
+const char* trad_ses_status_name(const TradSesStatus& status) noexcept {
+	switch(status) {
+		case TradSesStatus::Halted: return "Halted";
+		case TradSesStatus::Open: return "Open";
+		case TradSesStatus::Closed: return "Closed";
+		case TradSesStatus::PreOpen: return "PreOpen";
+		default:
+			return "Unknown";
+	}
+}
+
+enum class SecurityTradingStatus : uint8_t {
+	TradingHalt = 2u,
+	Closed = 4u,
+	ReadyToTrade = 17u,
+	NotAvailableForTrading = 18u,
+	NotTradedOnThisMarket = 19u,
+	UnknownOrInvalid = 20u,
+	PreOpen = 21u,
+	DiscreteAuctionOpen = 119u,
+	DiscreteAuctionClose = 120u,
+	InstrumentHalt = 121u,
+	Null = 255u
+};
+
+const char* security_trading_status_name(const SecurityTradingStatus& status) noexcept {
+	switch(status) {
+		case SecurityTradingStatus::TradingHalt: return "TradingHalt";
+		case SecurityTradingStatus::Closed: return "Closed";
+		case SecurityTradingStatus::ReadyToTrade: return "ReadyToTrade";
+		case SecurityTradingStatus::NotAvailableForTrading: return "NotAvailableForTrading";
+		case SecurityTradingStatus::NotTradedOnThisMarket: return "NotTradedOnThisMarket";
+		case SecurityTradingStatus::UnknownOrInvalid: return "UnknownOrInvalid";
+		case SecurityTradingStatus::PreOpen: return "PreOpen";
+		case SecurityTradingStatus::DiscreteAuctionOpen: return "DiscreteAuctionOpen";
+		case SecurityTradingStatus::DiscreteAuctionClose: return "DiscreteAuctionClose";
+		case SecurityTradingStatus::InstrumentHalt: return "InstrumentHalt";
+		case SecurityTradingStatus::Null: return "null";
+		default:
+			return "Unknown";
+	}
+}
+
 enum class TemplateId : uint16_t {
 	Heartbeat = 1u,
 	SequenceReset = 2u,